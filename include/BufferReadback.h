@@ -0,0 +1,34 @@
+#ifndef BUFFERREADBACK_H
+#define BUFFERREADBACK_H
+
+#include <glad/glad.h>
+
+// Reads GPU buffers back without stalling the pipeline: each copy goes into one of a few staging buffers behind a fence,
+// and is only read once the GPU has passed that fence. Results come back a few frames late, like GpuTimer's.
+class BufferReadback {
+public:
+    BufferReadback() = default;
+    ~BufferReadback();
+
+    BufferReadback(const BufferReadback&) = delete;
+    BufferReadback& operator=(const BufferReadback&) = delete;
+
+    // Copies the first size bytes of sourceBuffer, skipped while every staging buffer is still in flight
+    void queueCopy(GLuint sourceBuffer, GLsizeiptr size);
+
+    // Copies the newest finished copy into destination without blocking, false when none finished since the last call
+    bool readLatest(void* destination);
+
+private:
+    static constexpr int BUFFER_COUNT = 3;
+
+    void release();
+
+    GLuint stagingBuffers[BUFFER_COUNT]{};
+    GLsync fences[BUFFER_COUNT]{};
+    GLsizeiptr stagingSize = 0;
+    int nextBuffer = 0;
+    int pendingCopies = 0;
+};
+
+#endif //BUFFERREADBACK_H
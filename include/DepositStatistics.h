@@ -0,0 +1,25 @@
+#ifndef DEPOSITSTATISTICS_H
+#define DEPOSITSTATISTICS_H
+
+// Shared between C++ and deposit_spores.glsl. Counters of the binned deposit, every work group adds its totals once
+// after flushing its bins.
+
+#ifdef __cplusplus
+#include <cstdint>
+
+struct DepositStatistics {
+    uint32_t deposits;        // Spores that deposited trail
+    uint32_t binMerges;       // Deposits summed into a bin another spore of the same work group had already claimed
+    uint32_t globalAtomics;   // Compare and swaps issued on the trail grid
+    uint32_t atomicConflicts; // Compare and swaps that failed because another work group changed the voxel first
+};
+#else
+layout(std430, binding = 5) buffer DepositStatisticsBuffer {
+    uint deposits;
+    uint binMerges;
+    uint globalAtomics;
+    uint atomicConflicts;
+} depositStatistics;
+#endif
+
+#endif //DEPOSITSTATISTICS_H
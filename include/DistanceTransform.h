@@ -0,0 +1,43 @@
+#ifndef DISTANCETRANSFORM_H
+#define DISTANCETRANSFORM_H
+
+#include <cstdint>
+#include <vector>
+#include "ThreadPool.h"
+
+// Distance written for cells with no seed anywhere, matches the jump flood shaders
+constexpr float SDF_EMPTY_DISTANCE = 1e6f;
+
+struct DistanceFieldError {
+    float maxError = 0.0f;   // Largest |candidate - reference| distance, in voxels
+    float meanError = 0.0f;  // Mean over the cells where both fields found a seed
+    int missingSeeds = 0;    // Cells where only one of the two fields found a seed
+};
+
+// Exact Euclidean distance transform over the reduced SDF grid (Felzenszwalb & Huttenlocher, separable per axis).
+// Produces the same RGBA texels the jump flood writes for renderer.glsl: xyz = nearest seed in grid units, w = distance.
+class DistanceTransform {
+public:
+    explicit DistanceTransform(ThreadPool& threadPool);
+
+    // Marks every reduced cell containing an occupied voxel, from the occupancy bricks read back off the GPU.
+    // brickCountX/Y are the dimensions of the occupancy texture the words came from.
+    void seedsFromOccupancy(const std::vector<uint32_t>& occupancyWords, int brickCountX, int brickCountY,
+                            int gridSize, int reduction, std::vector<uint8_t>& seeds) const;
+
+    // seeds holds reducedSize^3 flags, sdfTexels receives reducedSize^3 RGBA texels
+    void compute(const std::vector<uint8_t>& seeds, int reducedSize, int reduction, std::vector<float>& sdfTexels);
+
+    // Compares the w channel of two RGBA SDF fields of the same size
+    static DistanceFieldError compare(const std::vector<float>& referenceTexels, const std::vector<float>& candidateTexels);
+
+private:
+    void transformAxis(int reducedSize, int stride, int lineStride, int sliceStride);
+
+    ThreadPool& pool;
+
+    std::vector<float> squaredDistances; // Squared distance to the nearest seed, in reduced cells
+    std::vector<int> features;           // Linear index of the nearest seed, -1 when there is none
+};
+
+#endif //DISTANCETRANSFORM_H
@@ -0,0 +1,82 @@
+#ifndef ENSEMBLE_H
+#define ENSEMBLE_H
+
+#include <glad/glad.h>
+#include <linmath.h>
+
+#include <cstdint>
+#include <vector>
+#include "SimulationData.h"
+#include "Spore.h"
+
+// Simulation passes built with USE_ENSEMBLE, they read the member settings and the atlas
+struct EnsemblePrograms {
+    GLuint randomizeSpores = 0;
+    GLuint moveSpores = 0;
+    GLuint drawSpores = 0;
+    GLuint decaySpores = 0;
+    GLuint clearGrid = 0;
+};
+
+// Runs several small simulations with their own SimulationData side by side. Their spores share one buffer and their
+// trail one 3D texture atlas, so every pass is a single dispatch over all members instead of one per member, which
+// keeps the GPU busy at grid sizes that leave it mostly idle alone (64-128). Members share the grid size and spore
+// count, their tiles form a square one tile deep so a projection along z shows all of them.
+class Ensemble {
+public:
+    Ensemble() = default;
+    ~Ensemble();
+
+    Ensemble(const Ensemble&) = delete;
+    Ensemble& operator=(const Ensemble&) = delete;
+
+    void setPrograms(const EnsemblePrograms& ensemblePrograms);
+
+    // Reallocates for the members and resets them. The first member's grid size, rounded up to whole work groups,
+    // and spore count apply to all of them.
+    void configure(const std::vector<SimulationData>& memberSettings);
+
+    // Clears every tile and scatters each member's spores, all members start from the same positions
+    void reset();
+
+    void step(float deltaTime);
+
+    // Binds the spores, member settings and atlas where the passes of the single simulation find theirs
+    void bind() const;
+
+    // Reads the whole atlas back, x fastest: atlasSize() wide, tileRowCount() * gridSize() high and gridSize() deep
+    void readAtlas(std::vector<float>& values) const;
+
+    // Reads one member's spores back as they are now
+    void readSpores(int member, std::vector<Spore>& spores) const;
+
+    // Grid size and spore count stay the ensemble's, the change reaches the GPU with the next step
+    void setMember(int member, const SimulationData& settings);
+
+    [[nodiscard]] const SimulationData& member(const int index) const { return members[index]; }
+    [[nodiscard]] int memberCount() const { return static_cast<int>(members.size()); }
+    [[nodiscard]] int gridSize() const { return memberGridSize; }
+    [[nodiscard]] int tilesPerRow() const { return tileColumns; }
+    [[nodiscard]] int tileRowCount() const { return tileRows; }
+    // Side of the square the tiles fill
+    [[nodiscard]] int atlasSize() const { return tileColumns * memberGridSize; }
+    [[nodiscard]] GLuint atlas() const { return atlasTexture; }
+    // Side of the atlas configure() allocates for the members, to check against GL_MAX_3D_TEXTURE_SIZE beforehand
+    [[nodiscard]] static int atlasSizeFor(int gridSize, int memberCount);
+    // Bumped whenever the atlas changes
+    [[nodiscard]] uint64_t generation() const { return trailGeneration; }
+
+private:
+    void uploadSettings() const;
+    void release();
+
+    EnsemblePrograms programs{};
+    std::vector<SimulationData> members;
+
+    GLuint sporesBuffer = 0, settingsBuffer = 0, atlasTexture = 0, occupancyTexture = 0;
+    int memberGridSize = 0, sporesPerMember = 0;
+    int tileColumns = 0, tileRows = 0;
+    uint64_t trailGeneration = 0;
+};
+
+#endif //ENSEMBLE_H
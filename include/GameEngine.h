@@ -12,7 +12,7 @@
 // Abstract base class for game engines
 class GameEngine {
 public:
-    GameEngine(int width, int height, std::string  title, bool vSync);
+    GameEngine(int width, int height, std::string  title, bool vSync, bool headless = false);
     virtual ~GameEngine();
 
     void run(); // Main game loop
@@ -36,6 +36,8 @@ public:
 
     void addShaderDefinition(const std::string& placeholder, const std::string& filePath);
     void removeShaderDefinition(const std::string &placeholder);
+    // Keeps a "#define" placeholder in the shader sources when enabled, strips it when disabled
+    void setShaderVariant(const std::string &placeholder, bool enabled);
 
     bool GetVsyncStatus() const;
     void SetVsyncStatus(bool status);
@@ -96,6 +98,7 @@ private:
     int maxWorkGroupSizeX{}, maxWorkGroupSizeY{}, maxWorkGroupSizeZ{};
 
     bool vSyncEnabled;
+    bool headless; // Hidden window, for benchmarks and batch runs
 
 
     // Callback setup
@@ -0,0 +1,36 @@
+#ifndef GPUTIMER_H
+#define GPUTIMER_H
+
+#include <glad/glad.h>
+
+// Measures the GPU time of the commands between begin() and end() with GL_TIME_ELAPSED queries.
+// Results come back a few frames late so reading them never stalls the pipeline. Timers must not overlap.
+class GpuTimer {
+public:
+    GpuTimer() = default;
+    ~GpuTimer();
+
+    GpuTimer(const GpuTimer&) = delete;
+    GpuTimer& operator=(const GpuTimer&) = delete;
+
+    void begin();
+    void end();
+
+    // Most recent finished measurement in milliseconds without blocking, -1 until one is available
+    float latestMilliseconds();
+
+    // Blocks until the last end() has finished on the GPU and returns its time in milliseconds
+    float waitMilliseconds();
+
+private:
+    static constexpr int QUERY_COUNT = 4;
+
+    void readOldest(bool wait);
+
+    GLuint queries[QUERY_COUNT]{};
+    int nextQuery = 0;
+    int pendingQueries = 0;
+    float latest = -1.0f;
+};
+
+#endif //GPUTIMER_H
@@ -0,0 +1,15 @@
+#ifndef IMAGEIO_H
+#define IMAGEIO_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Writes the frames and thumbnails the renderers produce, shared so the GPU projection and the tools don't depend on
+// the CPU renderer for it
+namespace ImageIO {
+    // Binary PPM, top row first, from width * height RGBA8 pixels stored bottom row first like glReadPixels
+    bool savePPM(const std::string& path, int width, int height, const std::vector<uint8_t>& rgba);
+}
+
+#endif //IMAGEIO_H
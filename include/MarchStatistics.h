@@ -0,0 +1,62 @@
+#ifndef MARCHSTATISTICS_H
+#define MARCHSTATISTICS_H
+
+// Shared between C++ and the shaders. With USE_MARCH_STATISTICS every marched pixel adds its ray's steps and
+// texel fetches (trail, SDF, occupancy, pyramid and baked density reads) to one buffer of sums, maxima and
+// histograms. The last histogram bin also holds everything past its range.
+#define MARCH_HISTOGRAM_BINS 256
+#define MARCH_STEP_BIN_WIDTH 8
+#define MARCH_FETCH_BIN_WIDTH 64
+
+#ifdef __cplusplus
+#include <cstdint>
+
+struct MarchStatistics {
+    uint32_t pixelCount;
+    uint32_t maxSteps;
+    uint32_t maxFetches;
+    uint32_t padding;
+    // 64-bit sums as low and high words, GLSL 4.3 has no 64-bit atomics
+    uint32_t stepSumLow, stepSumHigh;
+    uint32_t fetchSumLow, fetchSumHigh;
+    uint32_t stepHistogram[MARCH_HISTOGRAM_BINS];
+    uint32_t fetchHistogram[MARCH_HISTOGRAM_BINS];
+};
+#else
+layout(std430, binding = 4) buffer MarchStatisticsBuffer {
+    uint pixelCount;
+    uint maxSteps;
+    uint maxFetches;
+    uint padding;
+    uint stepSumLow, stepSumHigh;
+    uint fetchSumLow, fetchSumHigh;
+    uint stepHistogram[MARCH_HISTOGRAM_BINS];
+    uint fetchHistogram[MARCH_HISTOGRAM_BINS];
+} marchStatistics;
+
+// This invocation's counts, added to the buffer once its pixel is done
+uint marchSteps = 0u;
+uint marchFetches = 0u;
+
+#define COUNT_MARCH_STEP() marchSteps += 1u
+#define COUNT_TEXEL_FETCHES(count) marchFetches += uint(count)
+
+void record_march_statistics() {
+    atomicAdd(marchStatistics.pixelCount, 1u);
+    atomicMax(marchStatistics.maxSteps, marchSteps);
+    atomicMax(marchStatistics.maxFetches, marchFetches);
+
+    // The low word wrapped when its old value had less room left than was added
+    if (atomicAdd(marchStatistics.stepSumLow, marchSteps) > 0xFFFFFFFFu - marchSteps) {
+        atomicAdd(marchStatistics.stepSumHigh, 1u);
+    }
+    if (atomicAdd(marchStatistics.fetchSumLow, marchFetches) > 0xFFFFFFFFu - marchFetches) {
+        atomicAdd(marchStatistics.fetchSumHigh, 1u);
+    }
+
+    atomicAdd(marchStatistics.stepHistogram[min(marchSteps / uint(MARCH_STEP_BIN_WIDTH), uint(MARCH_HISTOGRAM_BINS - 1))], 1u);
+    atomicAdd(marchStatistics.fetchHistogram[min(marchFetches / uint(MARCH_FETCH_BIN_WIDTH), uint(MARCH_HISTOGRAM_BINS - 1))], 1u);
+}
+#endif
+
+#endif //MARCHSTATISTICS_H
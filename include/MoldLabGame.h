@@ -1,10 +1,23 @@
 #ifndef MOLDLABGAME_H
 #define MOLDLABGAME_H
 
+#include <algorithm>
+#include <deque>
 #include "GameEngine.h"
+#include "BufferReadback.h"
+#include "DepositStatistics.h"
+#include "DistanceTransform.h"
+#include "Ensemble.h"
+#include "GpuTimer.h"
+#include "MarchStatistics.h"
 #include "ShaderVariable.h"
+#include "SoftwareRenderer.h"
 #include "SimulationData.h"
 #include "Spore.h"
+#include "SporePopulation.h"
+#include "TrailDiffusion.h"
+#include "TrailMetrics.h"
+#include "TrailProjection.h"
 
 struct SimulationDefaults {
     static constexpr int GRID_SIZE = 400;
@@ -16,6 +29,8 @@ struct SimulationDefaults {
     static constexpr float SPORE_TURN_SPEED = 1.0f;
     static constexpr float SPORE_ROTATION_SPEED = 1.0f;
     static constexpr int SDF_REDUCTION_FACTOR = 2;
+    static constexpr float TRAIL_DIFFUSION_RATE = 5.0f;
+    static constexpr int SEED = 1;
 
     static constexpr float MAX_SPORE_COUNT = 1'000'000;
     static constexpr float MAX_GRID_SIZE = 500;
@@ -23,6 +38,55 @@ struct SimulationDefaults {
 
 
 
+// Which renderer draws the grid each frame
+enum class RenderMode {
+    Fragment, // Full-screen quad, one ray march per fragment
+    Compute,  // 8x8 screen tiles in a compute shader with early tile rejection, blitted to the screen
+    Instanced, // Voxels above a threshold compacted on the GPU and rasterized as cubes, cheaper for sparse grids
+    Software, // Ray marched on the CPU thread pool from a read back of the trail grid, uploaded and blitted
+    Projection, // Maximum or average of every voxel column along an axis, rebuilt once per simulation step
+    Slice,    // One layer of voxels along an axis, rebuilt once per simulation step
+};
+
+
+// Inputs of the passes derived from the trail grid (bake, pyramid, SDF), they only rerun when one of these changes
+struct DerivedPassInputs {
+    uint64_t trailGeneration = 0;        // Bumped whenever the trail grid changes
+    uint64_t renderShaderGeneration = 0; // Bumped whenever the render shaders are rebuilt with other variants
+    RenderMode renderMode = RenderMode::Fragment;
+    bool useCpuSdf = false;
+
+    bool operator==(const DerivedPassInputs& other) const {
+        return trailGeneration == other.trailGeneration && renderShaderGeneration == other.renderShaderGeneration &&
+               renderMode == other.renderMode && useCpuSdf == other.useCpuSdf;
+    }
+};
+
+// Inputs of a ray marched frame, while none of them change the last frame is shown again
+struct FrameInputs {
+    DerivedPassInputs derived;
+    float camera[6] = {}; // camera_position then camera_focus
+    int width = 0, height = 0;
+
+    bool operator==(const FrameInputs& other) const {
+        return derived == other.derived && std::equal(camera, camera + 6, other.camera) &&
+               width == other.width && height == other.height;
+    }
+};
+
+
+// One entry of the metrics time series, decoded from a TrailMetrics readback
+struct TrailMetricsSample {
+    uint32_t step = 0;               // Simulation step it was measured at
+    double trailMass = 0.0;
+    float occupiedFraction = 0.0f;   // Of the grid's voxels
+    float maxTrail = 0.0f;
+    int boundsMin[3] = {}, boundsMax[3] = {}; // Occupied voxel bounding box, empty when min is past max
+    float meanSporeSpeed = 0.0f;     // Voxels per second, net motion since the previous measurement
+    float meanTurnRate = 0.0f;       // Radians per second, net heading change since the previous measurement
+};
+
+
 struct InputState {
     bool isDPressed = false;
     bool isAPressed = false;
@@ -47,9 +111,26 @@ protected:
     void renderUI() override;
 
 private:
-    GLuint triangleVbo = 0, triangleVao = 0, voxelGridTexture = 0, simulationSettingsBuffer = 0, sporesBuffer = 0, sdfTexBuffer1 = 0, sdfTexBuffer2 = 0;
-    GLuint shaderProgram = 0, drawSporesShaderProgram = 0, moveSporesShaderProgram = 0, decaySporesShaderProgram = 0, jumpFloodInitShaderProgram = 0, jumpFloodStepShaderProgram = 0, clearGridShaderProgram = 0, randomizeSporesShaderProgram = 0, scaleSporesShaderProgram = 0;
-    ShaderVariable<int> jfaStepSV, maxSporeSizeSV;
+    GLuint triangleVbo = 0, triangleVao = 0, voxelGridTexture = 0, simulationSettingsBuffer = 0, sporesBuffer = 0, sdfTexBuffer1 = 0, sdfTexBuffer2 = 0, occupancyTexture = 0, trailPyramidTexture = 0, renderTexture = 0, renderFramebuffer = 0, depthPrepassTexture = 0, bakedDensityTexture = 0, voxelDrawBuffer = 0, voxelInstanceBuffer = 0, voxelInstanceVao = 0, trailReadFramebuffer = 0, accumulationTexture = 0, accumulationFramebuffer = 0, checkerboardDepthTexture = 0, checkerboardHistoryTexture = 0, marchStatisticsBuffer = 0, trailLodTexture = 0, depositStatisticsBuffer = 0, trailMetricsBuffer = 0, sporeSnapshotBuffer = 0, sporePopulationBuffer = 0, sporesBackBuffer = 0, sporeScanBuffer = 0;
+    GLuint shaderProgram = 0, drawSporesShaderProgram = 0, moveSporesShaderProgram = 0, decaySporesShaderProgram = 0, jumpFloodInitShaderProgram = 0, jumpFloodStepShaderProgram = 0, clearGridShaderProgram = 0, randomizeSporesShaderProgram = 0, scaleSporesShaderProgram = 0, buildTrailPyramidShaderProgram = 0, renderComputeShaderProgram = 0, depthPrepassShaderProgram = 0, bakeDensityShaderProgram = 0, compactVoxelsShaderProgram = 0, voxelInstancesShaderProgram = 0, upscaleShaderProgram = 0, checkerboardResolveShaderProgram = 0, projectTrailShaderProgram = 0, projectionViewShaderProgram = 0, buildTrailLodShaderProgram = 0, depositSporesShaderProgram = 0, diffuseTrailShaderProgram = 0, ensembleProjectTrailShaderProgram = 0, trailMetricsShaderProgram = 0, sporeMetricsShaderProgram = 0, sporeLifecycleShaderProgram = 0, resampleTrailShaderProgram = 0;
+    ShaderVariable<int> jfaStepSV, maxSporeSizeSV, pyramidLevelSV, lodLevelSV, diffusionAxisSV, checkerboardFrameSV, computeCheckerboardFrameSV, resolveCheckerboardFrameSV, checkerboardHistoryValidSV, lifecycleStageSV, lifecycleStepSV;
+    ShaderVariable<vec2> depthPrepassScreenSizeSV, pixelJitterSV, computePixelJitterSV;
+    vec2 depthPrepassScreenSize{};
+    vec2 pixelJitter{};
+    ShaderVariable<vec3> previousCameraPositionSV, previousCameraFocusSV;
+    vec3 previousCameraPosition{}, previousCameraFocus{};
+    int checkerboardFrame = -1; // Phase of the pattern marched this frame, -1 marches every pixel
+    int checkerboardHistoryValid = 0;
+    int diffusionAxis = 0;
+    ShaderVariable<float> voxelThresholdSV, voxelCameraCutoutRadiusSV, projectionExposureSV, trailLodDistanceSV, computeTrailLodDistanceSV, depositAmountSV, snapshotAgeSV, crowdingTrailSV, sporeDeathRateSV, spawnTrailSV, sporeSpawnRateSV;
+    ShaderVariable<vec2> projectionViewScaleSV;
+    vec2 projectionViewScale{};
+    ShaderVariable<vec3> voxelCameraPositionSV;
+    ShaderVariable<mat4x4> voxelViewProjectionSV;
+    float voxelThreshold = 0.01f;
+    float voxelCameraCutoutRadius = 0.0f;
+    vec3 voxelCameraPosition{};
+    mat4x4 voxelViewProjection{};
 
     SimulationData simulationSettings{};
 
@@ -59,26 +140,171 @@ private:
 
     bool useTransparency = true;
     bool wrapGrid = true;
-    bool gridSizeChanged = false;
+    bool useDiffusion = false;
+    int trailGridSize = SimulationDefaults::GRID_SIZE; // Grid size the trail and the spores are laid out for
+    int gridSizeSlider = SimulationDefaults::GRID_SIZE; // Dragged freely, becomes the grid size once released
+    bool useCpuSdf = false;
+    bool usePyramidSkipping = false;
+    RenderMode renderMode = RenderMode::Fragment;
+    int renderTextureWidth = 0, renderTextureHeight = 0;
+    float renderScale = 1.0f; // Fraction of the window resolution the ray marchers render at
+    bool useAutoRenderScale = false;
+    float targetRenderMilliseconds = 16.0f;
+    bool useEdgeAwareUpscale = false;
+    bool pauseSimulation = false;
+    bool reuseIdleFrames = true;
+    bool useProgressiveRefinement = false;
+    int accumulatedSamples = 0; // Jittered samples averaged into the current image
+    uint64_t trailGeneration = 1, renderShaderGeneration = 1;
+    DerivedPassInputs lastDerivedPassInputs{};
+    FrameInputs lastFrameInputs{};
+    bool useCheckerboard = false;
+    bool useQuarterCheckerboard = false;
+    bool lastFrameCheckerboarded = false; // Reused only after one full march fills in the reconstructed pixels
+    int checkerboardPhase = 0;
+    int checkerboardTargetWidth = 0, checkerboardTargetHeight = 0;
+    bool useDepthPrepass = false;
+    int depthPrepassWidth = 0, depthPrepassHeight = 0;
+    bool useBakedDensity = false;
+    bool useTrailSampler = false;
+    bool useTrilinearSensing = false;
+    bool useLodSensing = false;
+    bool useTrailLod = false;
+    float trailLodDistance = SimulationDefaults::GRID_SIZE; // From the camera, where transparent rays switch to coarse cells
+    uint64_t trailLodGeneration = 0; // Trail generation the mean chain was last built from
+
+    GpuTimer decayTimer, moveSporesTimer, depositTimer, renderTimer;
+
+    TrailProjection trailProjection;
+    int projectionAxis = 2;
+    ProjectionKind projectionKind = ProjectionKind::Maximum; // Of the projection view, the slice view always shows a slice
+    int projectionSlice = SimulationDefaults::GRID_SIZE / 2;
+    float projectionExposure = 1.0f;
+
+    bool useMarchStatistics = false;
+    BufferReadback marchStatisticsReadback;
+    MarchStatistics latestMarchStatistics{}; // A few frames old, all zero until the first readback
+
+    bool useBinnedDeposit = false;
+    float depositAmount = 1.0f; // Trail one spore adds per step with the binned deposit
+    BufferReadback depositStatisticsReadback;
+    DepositStatistics latestDepositStatistics{};
+
+    bool useTrailMetrics = false;
+    int metricsInterval = 10; // Simulation steps between two measurements
+    uint32_t simulationStep = 0;
+    uint32_t lastMeasuredStep = 0;
+    float timeSinceSnapshot = 0.0f; // Simulated seconds since the spore snapshot was taken
+    float snapshotAge = 0.0f;       // What spore_metrics.glsl gets, 0 while there is no valid snapshot
+    int snapshotSporeCount = 0;     // Spores in the snapshot, it is only compared against the same spores
+    int sporeSnapshotCapacity = 0;
+    GpuTimer metricsTimer;
+    BufferReadback trailMetricsReadback;
+    TrailMetrics latestTrailMetrics{};
+    std::deque<TrailMetricsSample> metricsHistory; // Oldest first, capped at MAX_METRICS_SAMPLES
+
+    bool useSporeLifecycle = false;
+    bool sporeLifecycleSupported = false; // Its buffers are bound past the 8 storage bindings GL 4.3 guarantees
+    int lifecycleStage = 0;
+    int lifecycleStep = 0;
+    float crowdingTrail = 0.9f;   // Trail from which a voxel counts as crowded
+    float sporeDeathRate = 0.5f;  // Per second in crowded voxels
+    float spawnTrail = 0.3f;      // Trail from which spores spawn, up to a crowded voxel
+    float sporeSpawnRate = 0.2f;  // Per second
+    uint32_t sporeCapacity = 0;   // Spores the lifecycle can grow to, 0 before it first ran
+    uint32_t sporeBufferCount = 0; // Spores the spore buffers hold, at least the capacity and the settings' count
+    BufferReadback sporePopulationReadback;
+    SporePopulation latestSporePopulation{}; // Only shown, the passes get the live count from the GPU itself
+
+    bool useEnsemble = false;
+    Ensemble ensemble;
+    TrailProjection ensembleProjection;
+    EnsemblePrograms ensemblePrograms{};
+    int ensembleMemberCount = 16;
+    int ensembleGridSize = 64;
+    int ensembleSporeCount = 20'000; // Per member
+    int ensembleSweptParameter = 0; // Index into ENSEMBLE_SWEPT_PARAMETERS
+    float ensembleSweepRange[2] = {5.0f, 20.0f}; // Swept parameter of the first and the last member
+    GpuTimer ensembleTimer;
+
+    ThreadPool threadPool;
+    DistanceTransform distanceTransform{threadPool};
+    std::vector<uint32_t> occupancyReadback;
+    std::vector<uint8_t> sdfSeeds;
+    std::vector<float> cpuSdfTexels;
+
+    SoftwareRenderer softwareRenderer{threadPool};
+    std::vector<float> trailReadback;
+    std::vector<uint8_t> softwareFrame;
+
+    DistanceFieldError jfaError{};
+    bool jfaErrorMeasured = false;
 
     InputState inputState;
 
     // Initialization Functions
     void initializeRenderShader(bool useTransparency);
     void initializeMoveSporesShader(bool wrapAround);
+    void initializeDecayShaders();
+    void initializeEnsembleShaders();
+    void initializeSporePassShaders();
 
     void initializeShaders();
     void initializeUniformVariables();
     void initializeVertexBuffers();
     void initializeVoxelGridBuffer();
+    void initializeOccupancyBuffer();
+    void initializeTrailPyramidBuffer();
     void initializeSDFBuffer();
+    void initializeBakedDensityBuffer();
+    void initializeRenderTarget(int width, int height);
+    void initializeDepthPrepassTarget(int tilesX, int tilesY);
+    void initializeCheckerboardTargets(int width, int height);
     void initializeSimulationBuffers();
+    void initializeVoxelInstanceBuffers();
+    void initializeMarchStatisticsBuffer();
+    void initializeTrailLodBuffer();
+    void initializeDepositStatisticsBuffer();
+    void initializeTrailMetricsBuffers();
+    void initializeSporeLifecycleBuffers();
 
     // Update Helpers
     void HandleCameraMovement(float orbitRadius, float deltaTime);
     void DispatchComputeShaders();
-    void executeJFA() const;
+    void buildTrailPyramid() const;
+    void buildTrailLod();
+    void depositSpores();
+    void stepSporeLifecycle();
+    void dispatchSporePass(GLuint program, GLintptr populationGroupsOffset) const;
+    void diffuseTrail();
+    void bakeDensity() const;
+    GLuint executeJFA() const;
+    void computeCpuSDF();
+    void executeCpuSDF();
+    void measureJFAError();
+    void renderCompute(int width, int height);
+    void renderDepthPrepass(int width, int height);
+    void resolveCheckerboard(int width, int height);
+    void readBackMarchStatistics();
+    void measureTrailMetrics();
+    void collectTrailMetrics();
+    void saveTrailMetrics(const std::string& path) const;
+    void renderVoxelInstances();
+    void renderProjection(int width, int height);
+    void readBackTrail();
+    void renderSoftware(int width, int height);
+    void presentRenderTarget(int width, int height);
+    void accumulateFrame(int width, int height);
+    FrameInputs currentFrameInputs(int width, int height) const;
+    void updateRenderScale();
+    void updateVoxelViewProjection();
     void resetSporesAndGrid() const;
+    void resampleGrid();
+    void resetSporePopulation();
+    void adoptLiveSporeCount();
+    void configureEnsemble();
+    SimulationData ensembleMemberSettings(int member) const;
+    void bindSimulationResources();
     void clearGrid() const;
 };
 
@@ -0,0 +1,62 @@
+#ifndef OCCUPANCYDATA_H
+#define OCCUPANCYDATA_H
+
+// Shared between C++ and the shaders. One R32UI word holds a 4x4x2 brick of voxels,
+// bit index = x + 4 * (y + 4 * z) inside the brick. Set when the voxel holds any trail.
+#define OCCUPANCY_BRICK_X 4
+#define OCCUPANCY_BRICK_Y 4
+#define OCCUPANCY_BRICK_Z 2
+
+#ifndef __cplusplus
+layout(binding = 3, r32ui) uniform uimage3D occupancyData;
+
+const ivec3 OCCUPANCY_BRICK_SIZE = ivec3(OCCUPANCY_BRICK_X, OCCUPANCY_BRICK_Y, OCCUPANCY_BRICK_Z);
+
+ivec3 occupancy_brick(in ivec3 voxel) {
+    return voxel / OCCUPANCY_BRICK_SIZE;
+}
+
+uint occupancy_bit(in ivec3 voxel) {
+    ivec3 local = voxel % OCCUPANCY_BRICK_SIZE;
+    return 1u << uint(local.x + OCCUPANCY_BRICK_X * (local.y + OCCUPANCY_BRICK_Y * local.z));
+}
+
+// Bits of one brick covered by the brick-local box [lo, hi] (inclusive)
+uint occupancy_box_mask(in ivec3 lo, in ivec3 hi) {
+    uint rowMask = ((1u << uint(hi.x - lo.x + 1)) - 1u) << uint(lo.x);
+    uint mask = 0u;
+    for (int z = lo.z; z <= hi.z; ++z) {
+        for (int y = lo.y; y <= hi.y; ++y) {
+            mask |= rowMask << uint(OCCUPANCY_BRICK_X * (y + OCCUPANCY_BRICK_Y * z));
+        }
+    }
+    return mask;
+}
+
+bool is_voxel_occupied(in ivec3 voxel) {
+    return (imageLoad(occupancyData, occupancy_brick(voxel)).x & occupancy_bit(voxel)) != 0u;
+}
+
+// True when no voxel inside the box [lo, hi] (inclusive, grid coordinates) holds any trail
+bool is_region_empty(in ivec3 lo, in ivec3 hi) {
+    ivec3 brickLo = occupancy_brick(lo);
+    ivec3 brickHi = occupancy_brick(hi);
+
+    for (int z = brickLo.z; z <= brickHi.z; ++z) {
+        for (int y = brickLo.y; y <= brickHi.y; ++y) {
+            for (int x = brickLo.x; x <= brickHi.x; ++x) {
+                ivec3 brick = ivec3(x, y, z);
+                ivec3 origin = brick * OCCUPANCY_BRICK_SIZE;
+                uint mask = occupancy_box_mask(max(lo, origin) - origin, min(hi, origin + OCCUPANCY_BRICK_SIZE - 1) - origin);
+
+                if ((imageLoad(occupancyData, brick).x & mask) != 0u) {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+#endif
+
+#endif //OCCUPANCYDATA_H
@@ -0,0 +1,72 @@
+#ifndef RANDOM_H
+#define RANDOM_H
+
+// Shared between C++ and the shaders. Counter-based random numbers: every draw is a pure function of the seed, a
+// stream (the spore) and the draw's index, so no state is carried and any spore can be reproduced on its own. Only
+// integer operations and an exact conversion to float, the numbers are bit-identical on every GPU and on the CPU.
+// The hash is PCG's output permutation applied to a single LCG step (Jarzynski and Olano, "Hash Functions for GPU
+// Rendering").
+
+// Draws of one spore in randomize_spores.glsl, its stream is its index
+#define SPORE_DRAW_POSITION 0u // x, y and z take three draws from here
+#define SPORE_DRAW_YAW 3u
+#define SPORE_DRAW_PITCH 4u
+
+// Draws of one spore in a lifecycle step of spore_lifecycle.glsl, whose seed also takes the step
+#define SPORE_DRAW_DEATH 5u
+#define SPORE_DRAW_SPAWN 6u
+
+#ifdef __cplusplus
+#include <cmath>
+#include <cstdint>
+
+namespace Random {
+using uint = uint32_t;
+using std::ldexp;
+#define RANDOM_FUNCTION inline
+#else
+#define RANDOM_FUNCTION
+#endif
+
+RANDOM_FUNCTION uint pcg_hash(uint value) {
+    uint state = value * 747796405u + 2891336453u;
+    uint word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+    return (word >> 22u) ^ word;
+}
+
+RANDOM_FUNCTION uint random_bits(uint seed, uint stream, uint draw) {
+    return pcg_hash(pcg_hash(pcg_hash(seed) + stream) + draw);
+}
+
+// Uniform in [0, 1) with 24 bits, every value exactly representable as a float
+RANDOM_FUNCTION float random_unit(uint seed, uint stream, uint draw) {
+    return ldexp(float(random_bits(seed, stream, draw) >> 8u), -24);
+}
+
+#ifdef __cplusplus
+}
+#else
+// Random yaw in [0, 2π] and pitch in [0, π] from the spore's yaw and pitch draws. Through sines and cosines it only
+// matches a CPU run to float precision.
+mat3 random_orientation(uint seed, uint stream) {
+    float randomYaw = random_unit(seed, stream, SPORE_DRAW_YAW) * 2.0 * 3.14159265359;
+    float randomPitch = random_unit(seed, stream, SPORE_DRAW_PITCH) * 3.14159265359;
+
+    mat3 yawRotation = mat3(
+    vec3(cos(randomYaw), 0.0, -sin(randomYaw)),
+    vec3(0.0, 1.0, 0.0),
+    vec3(sin(randomYaw), 0.0, cos(randomYaw))
+    );
+
+    mat3 pitchRotation = mat3(
+    vec3(1.0, 0.0, 0.0),
+    vec3(0.0, cos(randomPitch), sin(randomPitch)),
+    vec3(0.0, -sin(randomPitch), cos(randomPitch))
+    );
+
+    return pitchRotation * yawRotation;
+}
+#endif
+#undef RANDOM_FUNCTION
+
+#endif //RANDOM_H
@@ -76,4 +76,7 @@ void ShaderVariable<float>::upload() const;
 template <>
 void ShaderVariable<int>::upload() const;
 
+template <>
+void ShaderVariable<mat4x4>::upload() const;
+
 #endif // SHADER_VARIABLE_H
@@ -15,6 +15,9 @@ struct SimulationData {
     float delta_time;
     float grid_resize_factor;
     float aspect_ratio;
+    float diffusion_rate;       // How fast trail spreads into neighbouring voxels, only with USE_DIFFUSION
+    int seed;                   // Of the spores' starting positions and headings, see Random.h
+    int padding[3];             // Whole 16 bytes, arrays of settings have the same stride in C++ and std430
 };
 
 #endif //SIMULATIONDATA_H
\ No newline at end of file
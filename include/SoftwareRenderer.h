@@ -0,0 +1,35 @@
+#ifndef SOFTWARERENDERER_H
+#define SOFTWARERENDERER_H
+
+#include <linmath.h>
+
+#include <cstdint>
+#include <vector>
+#include "SimulationData.h"
+#include "ThreadPool.h"
+
+// Read-only view of the simulation state in the layouts the GPU uses
+struct SoftwareScene {
+    const float* trail = nullptr;              // grid_size^3 voxels, x fastest
+    const float* sdfTexels = nullptr;          // (grid_size / sdf_reduction)^3 RGBA texels as the jump flood writes them
+    const uint32_t* occupancyWords = nullptr;  // Occupancy bricks, see OccupancyData.h
+    int brickCountX = 0, brickCountY = 0, brickCountZ = 0;
+    SimulationData settings{};                 // Grid size, SDF reduction and camera
+};
+
+// CPU port of renderer.glsl's opaque and transparent ray marchers (without the pyramid and prepass variants).
+// The image is split into tiles across the thread pool, and each tile marches packets of PACKET_WIDTH rays side by side.
+class SoftwareRenderer {
+public:
+    static constexpr int PACKET_WIDTH = 8;
+
+    explicit SoftwareRenderer(ThreadPool& threadPool);
+
+    // Writes width * height RGBA8 pixels to rgba, bottom row first like glReadPixels
+    void render(const SoftwareScene& scene, int width, int height, bool transparent, std::vector<uint8_t>& rgba);
+
+private:
+    ThreadPool& pool;
+};
+
+#endif //SOFTWARERENDERER_H
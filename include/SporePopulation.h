@@ -0,0 +1,38 @@
+#ifndef SPOREPOPULATION_H
+#define SPOREPOPULATION_H
+
+// Shared between C++ and the shaders. With the spore lifecycle the number of live spores only exists on the GPU: the
+// lifecycle pass compacts the survivors and newborns to the front of the spore buffer and writes the count here,
+// together with the work group counts the spore passes are dispatched with indirectly. The CPU never waits for it.
+#define SPORE_GROUP_SIZE 8             // Move and draw, one spore per invocation
+#define SPORE_LIFECYCLE_GROUP_SIZE 256 // Lifecycle and binned deposit
+#define MAX_LIFECYCLE_SPORES (65535 * SPORE_GROUP_SIZE) // Most spores one indirect dispatch of the move pass covers
+
+#ifdef __cplusplus
+#include <cstdint>
+
+struct SporePopulation {
+    uint32_t sporeGroups[3];     // Indirect dispatch of the 8 wide spore passes
+    uint32_t liveCount;
+    uint32_t lifecycleGroups[3]; // Indirect dispatch of the 256 wide spore passes
+    uint32_t nextLiveCount;      // Total of the lifecycle's scan, becomes the live count once the spores are moved
+    uint32_t births, deaths;     // Of the last lifecycle step, cleared before it
+    uint32_t capacity;           // Spores the buffers hold, births past it are dropped
+    uint32_t padding;
+};
+#else
+layout(std430, binding = 8) buffer SporePopulationBuffer {
+    uint sporeGroups[3];
+    uint liveCount;
+    uint lifecycleGroups[3];
+    uint nextLiveCount;
+    uint births, deaths;
+    uint capacity;
+    uint padding;
+} population;
+
+// Bounds of the spore passes, the fixed count of the settings without the lifecycle
+#define LIVE_SPORE_COUNT population.liveCount
+#endif
+
+#endif //SPOREPOPULATION_H
@@ -0,0 +1,47 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+// Fixed set of worker threads for data parallel CPU work (distance transforms, software rendering)
+class ThreadPool {
+public:
+    explicit ThreadPool(unsigned int threadCount = std::thread::hardware_concurrency());
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Runs task(i) for every i in [begin, end) across the pool and the calling thread, blocks until all are done.
+    // Not re-entrant: only one parallelFor may run at a time.
+    void parallelFor(int begin, int end, const std::function<void(int)>& task);
+
+    // Number of threads working on a parallelFor, including the caller
+    [[nodiscard]] unsigned int size() const;
+
+private:
+    void workerLoop();
+    void runTasks(const std::function<void(int)>& task);
+
+    std::vector<std::thread> workers;
+
+    std::mutex mutex;
+    std::condition_variable wakeCondition;
+    std::condition_variable doneCondition;
+
+    const std::function<void(int)>* currentTask = nullptr;
+    std::atomic<int> nextIndex{0};
+    int endIndex = 0;
+    size_t busyWorkers = 0;
+    uint64_t generation = 0;
+    bool stopping = false;
+};
+
+#endif //THREADPOOL_H
@@ -0,0 +1,9 @@
+#ifndef TRAILDIFFUSION_H
+#define TRAILDIFFUSION_H
+
+// Shared between C++ and diffuse_trail.glsl. Every work group blurs whole lines of the grid in place, each held in
+// shared memory at the longest line the grid can have.
+#define DIFFUSION_LINES_PER_GROUP 16
+#define DIFFUSION_MAX_LINE_LENGTH 500 // At least SimulationDefaults::MAX_GRID_SIZE, checked where both are known
+
+#endif //TRAILDIFFUSION_H
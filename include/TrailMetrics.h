@@ -0,0 +1,53 @@
+#ifndef TRAILMETRICS_H
+#define TRAILMETRICS_H
+
+// Shared between C++, trail_metrics.glsl and spore_metrics.glsl. The metrics passes reduce the trail grid and the
+// spores to this block, every work group adds its totals once. Sums are fixed point in 64 bits as low and high words,
+// GLSL 4.3 has no 64-bit atomics. The histogram counts occupied voxels by trail value over (0, 1], values from 1 on
+// fall into the last bin.
+#define TRAIL_HISTOGRAM_BINS 32
+#define TRAIL_MASS_SCALE 65536.0
+#define SPORE_METRIC_SCALE 1024.0
+
+#ifdef __cplusplus
+#include <cstdint>
+
+struct TrailMetrics {
+    uint32_t occupiedVoxels;
+    uint32_t sporeCount;       // Spores whose motion was measured, 0 while there was no earlier snapshot
+    uint32_t maxTrail;         // Bits of the largest trail value, non-negative floats order like their bits
+    uint32_t step;             // Simulation step it was measured at, written with the reset
+    uint32_t massLow, massHigh; // Trail sum times TRAIL_MASS_SCALE
+    uint32_t speedSumLow, speedSumHigh; // Voxels per second times SPORE_METRIC_SCALE
+    uint32_t turnSumLow, turnSumHigh;   // Radians per second times SPORE_METRIC_SCALE
+    uint32_t padding2[2];
+    uint32_t boundsMin[4];     // Occupied voxel bounding box, xyz inclusive
+    uint32_t boundsMax[4];
+    uint32_t histogram[TRAIL_HISTOGRAM_BINS];
+};
+#else
+layout(std430, binding = 6) buffer TrailMetricsBuffer {
+    uint occupiedVoxels;
+    uint sporeCount;
+    uint maxTrail;
+    uint step;
+    uint massLow, massHigh;
+    uint speedSumLow, speedSumHigh;
+    uint turnSumLow, turnSumHigh;
+    uint padding2[2];
+    uint boundsMin[4];
+    uint boundsMax[4];
+    uint histogram[TRAIL_HISTOGRAM_BINS];
+} trailMetrics;
+
+// Adds a work group's total to a fixed point sum. The low word wrapped when its old value had less room left than
+// was added.
+#define ADD_METRIC_SUM(low, high, value, scale) { \
+    uint fixedValue = uint((value) * (scale) + 0.5); \
+    if (atomicAdd(trailMetrics.low, fixedValue) > 0xFFFFFFFFu - fixedValue) { \
+        atomicAdd(trailMetrics.high, 1u); \
+    } \
+}
+#endif
+
+#endif //TRAILMETRICS_H
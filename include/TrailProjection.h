@@ -0,0 +1,64 @@
+#ifndef TRAILPROJECTION_H
+#define TRAILPROJECTION_H
+
+#include <glad/glad.h>
+
+#include <cstdint>
+#include <string>
+#include "ShaderVariable.h"
+
+enum class ProjectionKind {
+    Maximum, // Brightest voxel of each column
+    Sum,     // Column sum divided by its length, an average intensity projection
+    Slice,   // One layer of voxels
+};
+
+struct ProjectionSettings {
+    int axis = 2; // Axis the view looks along, 0 x, 1 y, 2 z
+    ProjectionKind kind = ProjectionKind::Maximum;
+    int slice = 0; // Voxel layer shown by ProjectionKind::Slice
+
+    bool operator==(const ProjectionSettings& other) const {
+        return axis == other.axis && kind == other.kind && slice == other.slice;
+    }
+};
+
+// Flattens the trail grid along one axis into a square R32F image with project_trail.glsl: a parallel reduction over
+// every column of voxels, or a copy of one slice. The image is only rebuilt when the trail or the settings changed,
+// once per simulation step at most instead of per pixel per frame, and needs no visible window.
+class TrailProjection {
+public:
+    TrailProjection() = default;
+    ~TrailProjection();
+
+    TrailProjection(const TrailProjection&) = delete;
+    TrailProjection& operator=(const TrailProjection&) = delete;
+
+    // project_trail.glsl as built by the engine, it reads the trail through image unit 0 and the settings buffer
+    void setProgram(GLuint program);
+
+    void project(int gridSize, const ProjectionSettings& settings, uint64_t trailGeneration);
+
+    [[nodiscard]] GLuint texture() const { return image; }
+    [[nodiscard]] int size() const { return imageSize; }
+
+    // Reads the image back, box filters it to at most maxSize pixels a side and writes it as a PPM in the heat ramp
+    bool saveThumbnail(const std::string& path, int maxSize, float exposure) const;
+
+    // Black through red and yellow to white, same ramp as projection_view.glsl
+    static void heatColor(float value, uint8_t rgb[3]);
+
+private:
+    GLuint program = 0;
+    GLuint image = 0;
+    int imageSize = 0;
+
+    int axis = 0, kind = 0, slice = 0;
+    ShaderVariable<int> axisSV, kindSV, sliceSV;
+
+    ProjectionSettings lastSettings{};
+    uint64_t lastTrailGeneration = 0;
+    bool upToDate = false;
+};
+
+#endif //TRAILPROJECTION_H
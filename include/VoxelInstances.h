@@ -0,0 +1,20 @@
+#ifndef VOXELINSTANCES_H
+#define VOXELINSTANCES_H
+
+// Shared between C++ and the shaders. compact_voxels.glsl appends every voxel above the threshold to the instance
+// buffer and counts them straight into the indirect draw command, voxel_instances.glsl draws a cube per instance.
+// An instance is two words: x | y << 10 | z << 20 and the trail value's float bits.
+#define MAX_VOXEL_INSTANCES 4194304
+#define VOXEL_CUBE_VERTICES 36
+
+#ifndef __cplusplus
+uvec2 pack_voxel_instance(in ivec3 voxel, in float value) {
+    return uvec2(uint(voxel.x) | uint(voxel.y) << 10 | uint(voxel.z) << 20, floatBitsToUint(value));
+}
+
+ivec3 unpack_voxel_position(in uvec2 instance) {
+    return ivec3(instance.x & 1023u, (instance.x >> 10) & 1023u, (instance.x >> 20) & 1023u);
+}
+#endif
+
+#endif //VOXELINSTANCES_H
@@ -0,0 +1,46 @@
+#version 430
+
+layout(local_size_x = 8, local_size_y = 8, local_size_z = 8) in;
+
+#define USE_TRAIL_SAMPLER
+
+// Simulation Settings
+#define SIMULATION_SETTINGS
+
+#define OCCUPANCY_DATA
+
+layout(std430, binding = 1) buffer SettingsBuffer {
+    SimulationData settings;
+};
+
+layout(binding = 0, r32f) uniform image3D voxelData;
+
+#define TRAIL_ACCESS
+
+layout(rgba32f, binding = 1) uniform readonly image3D sdfData;
+
+// Shares the pyramid write unit, only eight image units are guaranteed and the pyramid rebinds it per level
+layout(r16f, binding = 5) uniform writeonly image3D densityWrite;
+
+#define RAY_MARCHING
+
+
+void main() {
+    ivec3 texel = ivec3(gl_GlobalInvocationID.xyz);
+
+    // One texel past the last voxel, so trilinear samples up to the far faces of the grid stay inside the bake
+    if (any(greaterThan(texel, ivec3(settings.grid_size)))) {
+        return;
+    }
+
+    // Same neighbourhood and clamp map_the_world uses, evaluated once at the voxel centre
+    ivec3 searchMin = max(texel - 1, ivec3(0));
+    ivec3 searchMax = min(texel + 1, ivec3(settings.grid_size - 1));
+
+    float density = 1.0;
+    if (!is_region_empty(searchMin, searchMax)) {
+        density = min(1.0, smooth_voxel_blend(vec3(texel), searchMin, searchMax));
+    }
+
+    imageStore(densityWrite, texel, vec4(density, 0.0, 0.0, 0.0));
+}
@@ -0,0 +1,53 @@
+#version 430
+
+layout(local_size_x = 8, local_size_y = 8, local_size_z = 8) in;
+
+// Simulation Settings
+#define SIMULATION_SETTINGS
+
+
+layout(std430, binding = 1) buffer SettingsBuffer {
+    SimulationData settings;
+};
+
+layout(binding = 0, r32f) uniform image3D voxelData;
+
+// Mean trail, level 0 covers 2x2x2 voxels and each level above doubles that
+layout(r16f, binding = 4) uniform readonly image3D lodRead;
+layout(r16f, binding = 5) uniform writeonly image3D lodWrite;
+
+// Level being written, level 0 averages the voxel grid itself
+uniform int lodLevel;
+
+
+void main() {
+    ivec3 cell = ivec3(gl_GlobalInvocationID.xyz);
+
+    int cellSize = 2 << lodLevel; // Voxels along one side of a cell at this level
+    int levelSize = (settings.grid_size + cellSize - 1) / cellSize;
+
+    if (any(greaterThanEqual(cell, ivec3(levelSize)))) {
+        return;
+    }
+
+    // Children are either voxels or cells of the level below
+    int childCellSize = cellSize / 2;
+    int childLevelSize = (settings.grid_size + childCellSize - 1) / childCellSize;
+
+    float sum = 0.0;
+    int childCount = 0;
+
+    for (int i = 0; i < 8; ++i) {
+        ivec3 child = cell * 2 + ivec3(i & 1, (i >> 1) & 1, i >> 2);
+
+        // Children past the edge of the grid do not exist, edge cells average the ones that do
+        if (any(greaterThanEqual(child, ivec3(childLevelSize)))) {
+            continue;
+        }
+
+        sum += lodLevel == 0 ? imageLoad(voxelData, child).x : imageLoad(lodRead, child).x;
+        childCount++;
+    }
+
+    imageStore(lodWrite, cell, vec4(sum / float(childCount)));
+}
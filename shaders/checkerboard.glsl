@@ -0,0 +1,43 @@
+// Checkerboard rendering: each frame only part of the pixels is ray marched, checkerboard_resolve.glsl
+// reconstructs the others from their marched neighbours and the previous frame.
+
+// Frame counter rotating the pattern, -1 marches every pixel
+uniform int checkerboardFrame;
+
+// Distance from the camera to what each marched pixel shows, the resolve pass reprojects with it
+layout(r32f, binding = 2) uniform image2D checkerboardDepth;
+
+// Half the pixels in a checkerboard, or with USE_QUARTER_CHECKERBOARD one pixel of every 2x2 block
+bool checkerboard_marches(in ivec2 pixel) {
+    if (checkerboardFrame < 0) {
+        return true;
+    }
+    #ifdef USE_QUARTER_CHECKERBOARD
+    return ((pixel.x & 1) | (pixel.y & 1) << 1) == (checkerboardFrame & 3);
+    #else
+    return ((pixel.x + pixel.y + checkerboardFrame) & 1) == 0;
+    #endif
+}
+
+// Rays without an opaque hit (misses and the transparent view) are placed where they pass the orbit's focus
+void checkerboard_store_depth(in ivec2 pixel, in vec3 rayDirection, in float hitDistance) {
+    vec3 cameraPosition = settings.camera_position.xyz;
+    float focusDistance = max(dot(settings.camera_focus.xyz - cameraPosition, rayDirection), 0.0);
+    imageStore(checkerboardDepth, pixel, vec4(hitDistance >= 0.0 ? hitDistance : focusDistance));
+}
+
+// Same basis as camera_ray, for any camera
+mat3 checkerboard_camera_basis(in vec3 cameraPosition, in vec3 cameraFocus) {
+    vec3 forward = normalize(cameraFocus - cameraPosition);
+    vec3 right = normalize(cross(vec3(0.0, 1.0, 0.0), forward));
+    vec3 up = cross(forward, right);
+    return mat3(right, up, forward);
+}
+
+// Inverse of camera_ray, screenUV runs from -1 to 1 on both axes. False when the point is behind the camera.
+bool checkerboard_project(in vec3 point, in vec3 cameraPosition, in vec3 cameraFocus, out vec2 screenUV) {
+    vec3 view = transpose(checkerboard_camera_basis(cameraPosition, cameraFocus)) * (point - cameraPosition);
+    screenUV = view.xy / max(view.z, 1e-4);
+    screenUV.x /= settings.aspect_ratio;
+    return view.z > 0.0;
+}
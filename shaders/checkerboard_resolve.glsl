@@ -0,0 +1,82 @@
+#version 430
+
+layout(local_size_x = 8, local_size_y = 8, local_size_z = 1) in;
+
+#define USE_QUARTER_CHECKERBOARD
+
+#define SIMULATION_SETTINGS
+
+layout(std430, binding = 1) buffer SettingsBuffer {
+    SimulationData settings;
+};
+
+#define CHECKERBOARD_PATTERN
+
+// Marched pixels are read, the others written, so no pixel is both within one dispatch
+layout(rgba8, binding = 6) uniform image2D renderTarget;
+
+// Last frame's final image
+layout(binding = 5) uniform sampler2D checkerboardHistory;
+
+// Camera the history was rendered with
+uniform vec3 previousCameraPosition;
+uniform vec3 previousCameraFocus;
+
+// 0 when the history does not match this frame's size or look, only the neighbours are used then
+uniform int historyValid;
+
+
+void main() {
+    ivec2 pixel = ivec2(gl_GlobalInvocationID.xy);
+    ivec2 imageSize = imageSize(renderTarget);
+
+    if (any(greaterThanEqual(pixel, imageSize)) || checkerboard_marches(pixel)) {
+        return;
+    }
+
+    // The marched pixels around this one, both halves of the pattern have some in every 3x3 block
+    vec3 colorSum = vec3(0.0);
+    vec3 colorMin = vec3(1.0);
+    vec3 colorMax = vec3(0.0);
+    float neighbourCount = 0.0;
+    float nearestDepth = 1e30;
+
+    for (int i = 0; i < 9; ++i) {
+        ivec2 neighbour = pixel + ivec2(i % 3, i / 3) - 1;
+        if (any(lessThan(neighbour, ivec2(0))) || any(greaterThanEqual(neighbour, imageSize)) || !checkerboard_marches(neighbour)) {
+            continue;
+        }
+
+        vec3 color = imageLoad(renderTarget, neighbour).rgb;
+        colorSum += color;
+        colorMin = min(colorMin, color);
+        colorMax = max(colorMax, color);
+        neighbourCount += 1.0;
+
+        // The nearest surface wins, edges keep the foreground's motion
+        nearestDepth = min(nearestDepth, imageLoad(checkerboardDepth, neighbour).x);
+    }
+
+    if (neighbourCount == 0.0) {
+        return;
+    }
+
+    vec3 color = colorSum / neighbourCount;
+
+    if (historyValid != 0) {
+        // Where this pixel's ray reaches, seen from the previous camera
+        vec2 uv = (vec2(pixel) + 0.5) / vec2(imageSize) * 2.0 - 1.0;
+        mat3 basis = checkerboard_camera_basis(settings.camera_position.xyz, settings.camera_focus.xyz);
+        vec3 rayDirection = normalize(basis * vec3(uv.x * settings.aspect_ratio, uv.y, 1.0));
+        vec3 point = settings.camera_position.xyz + rayDirection * nearestDepth;
+
+        vec2 previousUV;
+        if (checkerboard_project(point, previousCameraPosition, previousCameraFocus, previousUV) && all(lessThanEqual(abs(previousUV), vec2(1.0)))) {
+            // Clamping to the neighbours rejects history that was disoccluded or changed since
+            vec3 history = texture(checkerboardHistory, previousUV * 0.5 + 0.5).rgb;
+            color = clamp(history, colorMin, colorMax);
+        }
+    }
+
+    imageStore(renderTarget, pixel, vec4(color, 1.0));
+}
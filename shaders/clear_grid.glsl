@@ -1,28 +1,46 @@
 #version 430
 
+#define USE_ENSEMBLE
 
 // Simulation Settings
 #define SIMULATION_SETTINGS
 
+#define OCCUPANCY_DATA
+
 layout(local_size_x = 8, local_size_y = 8, local_size_z = 8) in;
 
 layout(binding = 0, r32f) uniform image3D voxelData;
 
+#ifdef USE_ENSEMBLE
+#define ENSEMBLE_MEMBERS
+#else
 layout(std430, binding = 1) buffer SettingsBuffer {
     SimulationData settings;
 };
 
+// A single simulation fills the grid from its corner
+const ivec3 memberOrigin = ivec3(0);
+#endif
+
 
 void main() {
     // Get the 3D indices of the current work item
-    uint x = gl_GlobalInvocationID.x;
-    uint y = gl_GlobalInvocationID.y;
-    uint z = gl_GlobalInvocationID.z;
+    ivec3 location = ivec3(gl_GlobalInvocationID);
+
+    #ifdef USE_ENSEMBLE
+    // The dispatch covers the whole atlas
+    select_member_at(location);
+    #endif
 
     // Ensure the indices are within the bounds of the grid
-    if (x >= uint(settings.grid_size) || y >= uint(settings.grid_size) || z >= uint(settings.grid_size)) {
+    if (any(greaterThanEqual(location - memberOrigin, ivec3(settings.grid_size)))) {
         return;
     }
 
-    imageStore(voxelData, ivec3(x, y, z), vec4(0.0));
+    imageStore(voxelData, location, vec4(0.0));
+
+    // One invocation per brick clears its occupancy word
+    if (all(equal(location % OCCUPANCY_BRICK_SIZE, ivec3(0)))) {
+        imageStore(occupancyData, occupancy_brick(location), uvec4(0u));
+    }
 }
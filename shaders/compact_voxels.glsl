@@ -0,0 +1,70 @@
+#version 430
+
+layout(local_size_x = 8, local_size_y = 8, local_size_z = 8) in;
+
+// Simulation Settings
+#define SIMULATION_SETTINGS
+
+#define OCCUPANCY_DATA
+
+#define VOXEL_INSTANCES
+
+layout(std430, binding = 1) buffer SettingsBuffer {
+    SimulationData settings;
+};
+
+// Laid out as the DrawArraysIndirectCommand glDrawArraysIndirect reads, the CPU resets it before every compaction
+layout(std430, binding = 2) buffer VoxelDrawBuffer {
+    uint vertexCount;
+    uint instanceCount;
+    uint firstVertex;
+    uint baseInstance;
+} voxelDraw;
+
+layout(std430, binding = 3) writeonly buffer VoxelInstanceBuffer {
+    uvec2 voxelInstances[];
+};
+
+layout(binding = 0, r32f) uniform image3D voxelData;
+
+// Voxels at or below this are left out, like the cubes map_the_world skips
+uniform float voxelThreshold;
+
+// Voxels kept by this work group, and where they start in the instance buffer
+shared uint groupCount;
+shared uint groupBase;
+
+
+void main() {
+    if (gl_LocalInvocationIndex == 0u) {
+        groupCount = 0u;
+    }
+    barrier();
+
+    ivec3 voxel = ivec3(gl_GlobalInvocationID);
+
+    // Most of the grid is empty, the occupancy bit saves the trail fetch there
+    float voxelValue = 0.0;
+    if (all(lessThan(voxel, ivec3(settings.grid_size))) && is_voxel_occupied(voxel)) {
+        voxelValue = imageLoad(voxelData, voxel).x;
+    }
+
+    bool keep = voxelValue > voxelThreshold;
+    uint localSlot = keep ? atomicAdd(groupCount, 1u) : 0u;
+    barrier();
+
+    // One global atomic per work group instead of one per voxel
+    if (gl_LocalInvocationIndex == 0u && groupCount > 0u) {
+        groupBase = atomicAdd(voxelDraw.instanceCount, groupCount);
+
+        // Whoever pushes the count past the buffer clamps it again afterwards, so it ends at the capacity
+        if (groupBase + groupCount > uint(MAX_VOXEL_INSTANCES)) {
+            atomicMin(voxelDraw.instanceCount, uint(MAX_VOXEL_INSTANCES));
+        }
+    }
+    barrier();
+
+    if (keep && groupBase + localSlot < uint(MAX_VOXEL_INSTANCES)) {
+        voxelInstances[groupBase + localSlot] = pack_voxel_instance(voxel, voxelValue);
+    }
+}
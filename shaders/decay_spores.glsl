@@ -1,30 +1,158 @@
 #version 430
 
+#define USE_DIFFUSION
+
+#define WRAP_AROUND
+
+#define USE_ENSEMBLE
 
 // Simulation Settings
 #define SIMULATION_SETTINGS
 
+#define OCCUPANCY_DATA
+
+#ifdef USE_DIFFUSION
+layout(local_size_x = 8, local_size_y = 8, local_size_z = 1) in;
+#else
 layout(local_size_x = 8, local_size_y = 8, local_size_z = 8) in;
+#endif
 
 layout(binding = 0, r32f) uniform image3D voxelData;
 
+#ifdef USE_ENSEMBLE
+#define ENSEMBLE_MEMBERS
+#else
 layout(std430, binding = 1) buffer SettingsBuffer {
     SimulationData settings;
 };
 
+// A single simulation fills the grid from its corner
+const ivec3 memberOrigin = ivec3(0);
+#endif
+
+#ifdef USE_DIFFUSION
+// Every invocation walks one column of the grid along z, the group's 8x8 columns cover whole occupancy bricks
+// of each layer so it owns their words and can overwrite them
+const ivec2 GROUP_BRICKS = ivec2(gl_WorkGroupSize.xy) / OCCUPANCY_BRICK_SIZE.xy;
+const uint GROUP_BRICK_COUNT = uint(GROUP_BRICKS.x * GROUP_BRICKS.y);
+
+shared uint brickBits[GROUP_BRICK_COUNT];
 
+
+// Blurs the column in place along z after diffuse_trail.glsl did x and y, then decays it. The walk keeps the
+// original neighbours in registers, the one before has already been overwritten in the image.
 void main() {
+    // Dispatched over one layer of work groups, a deeper dispatch would walk every column once per layer
+    if (gl_WorkGroupID.z != 0u) {
+        return;
+    }
+
+    uint localIndex = gl_LocalInvocationIndex;
+    int gridSize = settings.grid_size;
+
+    ivec2 column = ivec2(gl_GlobalInvocationID.xy);
+    bool validColumn = all(lessThan(column, ivec2(gridSize)));
+
+    ivec2 localBrick = ivec2(gl_LocalInvocationID.xy) / OCCUPANCY_BRICK_SIZE.xy;
+    uint brickIndex = uint(localBrick.x + GROUP_BRICKS.x * localBrick.y);
+
+    float sideWeight = clamp(settings.diffusion_rate * settings.delta_time, 0.0, 1.0) / 3.0;
+    float decay = settings.decay_speed * settings.delta_time;
+
+    float current = 0.0, before = 0.0, first = 0.0;
+    if (validColumn) {
+        current = imageLoad(voxelData, ivec3(column, 0)).x;
+        first = current;
+
+        #ifdef WRAP_AROUND
+        before = imageLoad(voxelData, ivec3(column, gridSize - 1)).x;
+        #else
+        // Nothing flows out through the faces of the grid
+        before = current;
+        #endif
+    }
+
+    // One layer of bricks at a time, the columns past the grid still have to reach the barriers
+    for (int layer = 0; layer < gridSize; layer += OCCUPANCY_BRICK_Z) {
+        if (localIndex < GROUP_BRICK_COUNT) {
+            brickBits[localIndex] = 0u;
+        }
+        barrier();
+
+        if (validColumn) {
+            for (int z = layer; z < min(layer + OCCUPANCY_BRICK_Z, gridSize); ++z) {
+                #ifdef WRAP_AROUND
+                float after = z + 1 < gridSize ? imageLoad(voxelData, ivec3(column, z + 1)).x : first;
+                #else
+                float after = z + 1 < gridSize ? imageLoad(voxelData, ivec3(column, z + 1)).x : current;
+                #endif
+
+                float diffused = current + sideWeight * (before + after - 2.0 * current);
+                float voxelValue = max(0.0, diffused - decay);
+                imageStore(voxelData, ivec3(column, z), vec4(voxelValue));
+
+                if (voxelValue > 0.0) {
+                    atomicOr(brickBits[brickIndex], occupancy_bit(ivec3(column, z)));
+                }
+
+                before = current;
+                current = after;
+            }
+        }
+        barrier();
+
+        if (localIndex < GROUP_BRICK_COUNT) {
+            ivec2 groupBrick = ivec2(int(localIndex) % GROUP_BRICKS.x, int(localIndex) / GROUP_BRICKS.x);
+            ivec3 brick = ivec3(ivec2(gl_WorkGroupID.xy) * GROUP_BRICKS + groupBrick, layer / OCCUPANCY_BRICK_Z);
+
+            if (all(lessThan(brick * OCCUPANCY_BRICK_SIZE, ivec3(gridSize)))) {
+                imageStore(occupancyData, brick, uvec4(brickBits[localIndex]));
+            }
+        }
+    }
+}
+#else
+// The work group covers whole occupancy bricks, so it owns their words and can overwrite them
+const ivec3 GROUP_BRICKS = ivec3(gl_WorkGroupSize) / OCCUPANCY_BRICK_SIZE;
+const uint GROUP_BRICK_COUNT = uint(GROUP_BRICKS.x * GROUP_BRICKS.y * GROUP_BRICKS.z);
+
+shared uint brickBits[GROUP_BRICK_COUNT];
+
+
+void main() {
+    uint localIndex = gl_LocalInvocationIndex;
+    if (localIndex < GROUP_BRICK_COUNT) {
+        brickBits[localIndex] = 0u;
+    }
+    barrier();
+
     // Get the 3D indices of the current work item
-    uint x = gl_GlobalInvocationID.x;
-    uint y = gl_GlobalInvocationID.y;
-    uint z = gl_GlobalInvocationID.z;
+    ivec3 location = ivec3(gl_GlobalInvocationID);
 
-    // Ensure the indices are within the bounds of the grid
-    if (x >= uint(settings.grid_size) || y >= uint(settings.grid_size) || z >= uint(settings.grid_size)) {
-        return;
+    #ifdef USE_ENSEMBLE
+    // The dispatch covers the whole atlas, the grid size is a multiple of the group size so each group stays in one tile
+    select_member_at(location);
+    #endif
+
+    // Out of bounds invocations still have to reach the barriers below
+    if (all(lessThan(location - memberOrigin, ivec3(settings.grid_size)))) {
+        float voxelValue = max(0.0, imageLoad(voxelData, location).x - settings.decay_speed * settings.delta_time);
+        imageStore(voxelData, location, vec4(voxelValue));
+
+        if (voxelValue > 0.0) {
+            ivec3 localBrick = ivec3(gl_LocalInvocationID) / OCCUPANCY_BRICK_SIZE;
+            atomicOr(brickBits[localBrick.x + GROUP_BRICKS.x * (localBrick.y + GROUP_BRICKS.y * localBrick.z)], occupancy_bit(location));
+        }
     }
+    barrier();
 
-    ivec3 location = ivec3(x,y,z);
-    float voxelValue = max(0.0, imageLoad(voxelData, location).x - settings.decay_speed * settings.delta_time);
-    imageStore(voxelData, location, vec4(voxelValue));
+    if (localIndex < GROUP_BRICK_COUNT) {
+        ivec3 localBrick = ivec3(localIndex % GROUP_BRICKS.x, (localIndex / GROUP_BRICKS.x) % GROUP_BRICKS.y, localIndex / (GROUP_BRICKS.x * GROUP_BRICKS.y));
+        ivec3 brick = ivec3(gl_WorkGroupID) * GROUP_BRICKS + localBrick;
+
+        if (all(lessThan(brick * OCCUPANCY_BRICK_SIZE - memberOrigin, ivec3(settings.grid_size)))) {
+            imageStore(occupancyData, brick, uvec4(brickBits[localIndex]));
+        }
+    }
 }
+#endif
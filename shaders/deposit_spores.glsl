@@ -0,0 +1,128 @@
+#version 430
+
+#define USE_SPORE_LIFECYCLE
+
+#define SPORE_STRUCT
+
+// Simulation Settings
+#define SIMULATION_SETTINGS
+
+#define OCCUPANCY_DATA
+
+#define DEPOSIT_STATISTICS
+
+layout(local_size_x = 256, local_size_y = 1, local_size_z = 1) in;
+
+// The trail grid seen as raw bits, GL 4.3 has no float image atomics so the add goes through compare and swap
+layout(binding = 5, r32ui) uniform uimage3D voxelBits;
+
+// Buffers
+layout(std430, binding = 0) buffer SporesBuffer {
+    Spore spores[];
+};
+
+layout(std430, binding = 1) buffer SettingsBuffer {
+    SimulationData settings;
+};
+
+#ifdef USE_SPORE_LIFECYCLE
+#define SPORE_POPULATION
+#else
+// Every spore of the settings is alive
+#define LIVE_SPORE_COUNT uint(settings.spore_count)
+#endif
+
+// Trail every spore adds to the voxel it is in, a voxel saturates at 1 like the store-only kernel's mark
+uniform float depositAmount;
+
+// Deposits are summed in fixed point in shared memory, exact whatever order the spores arrive in
+const float DEPOSIT_FIXED_POINT_SCALE = 65536.0;
+
+// Spores of the work group landing in the same voxel share a bin, keyed by voxel index + 1 with 0 for empty.
+// Twice as many bins as invocations, so linear probing always finds one.
+const uint BIN_BITS = 9u;
+const uint BIN_COUNT = 1u << BIN_BITS;
+
+shared uint binKeys[BIN_COUNT];
+shared uint binAmounts[BIN_COUNT];
+shared uint groupDeposits, groupMerges, groupAtomics, groupConflicts;
+
+
+void main() {
+    uint localIndex = gl_LocalInvocationIndex;
+    for (uint bin = localIndex; bin < BIN_COUNT; bin += gl_WorkGroupSize.x) {
+        binKeys[bin] = 0u;
+        binAmounts[bin] = 0u;
+    }
+    if (localIndex == 0u) {
+        groupDeposits = 0u;
+        groupMerges = 0u;
+        groupAtomics = 0u;
+        groupConflicts = 0u;
+    }
+    barrier();
+
+    int gridSize = settings.grid_size;
+    uint sporeID = gl_GlobalInvocationID.x;
+
+    // Out of range invocations still have to reach the barriers below
+    if (sporeID < LIVE_SPORE_COUNT) {
+        vec3 sporePosition = spores[sporeID].position.xyz;
+        ivec3 voxelCoord = clamp(ivec3(floor(sporePosition)), ivec3(0), ivec3(gridSize - 1));
+
+        uint key = uint(voxelCoord.x + gridSize * (voxelCoord.y + gridSize * voxelCoord.z)) + 1u;
+        uint amount = uint(depositAmount * DEPOSIT_FIXED_POINT_SCALE + 0.5);
+
+        // Fibonacci hash of the key, then the next bin until one is free or already holds this voxel
+        uint bin = (key * 2654435761u) >> (32u - BIN_BITS);
+        for (uint probe = 0u; probe < BIN_COUNT; ++probe) {
+            uint previousKey = atomicCompSwap(binKeys[bin], 0u, key);
+            if (previousKey == 0u || previousKey == key) {
+                atomicAdd(binAmounts[bin], amount);
+                if (previousKey == key) {
+                    atomicAdd(groupMerges, 1u);
+                }
+                break;
+            }
+            bin = (bin + 1u) & (BIN_COUNT - 1u);
+        }
+        atomicAdd(groupDeposits, 1u);
+    }
+    barrier();
+
+    // One global update per distinct voxel of the work group instead of one per spore
+    for (uint bin = localIndex; bin < BIN_COUNT; bin += gl_WorkGroupSize.x) {
+        uint key = binKeys[bin];
+        if (key == 0u || binAmounts[bin] == 0u) {
+            continue;
+        }
+
+        int index = int(key - 1u);
+        ivec3 voxel = ivec3(index % gridSize, (index / gridSize) % gridSize, index / (gridSize * gridSize));
+        float deposit = float(binAmounts[bin]) / DEPOSIT_FIXED_POINT_SCALE;
+
+        imageAtomicOr(occupancyData, occupancy_brick(voxel), occupancy_bit(voxel));
+
+        // Saturated voxels need no atomic at all, every failed swap means another work group wrote the voxel first
+        uint expected = imageLoad(voxelBits, voxel).x;
+        while (uintBitsToFloat(expected) < 1.0) {
+            uint desired = floatBitsToUint(min(uintBitsToFloat(expected) + deposit, 1.0));
+            uint previous = imageAtomicCompSwap(voxelBits, voxel, expected, desired);
+            atomicAdd(groupAtomics, 1u);
+
+            if (previous == expected) {
+                break;
+            }
+            atomicAdd(groupConflicts, 1u);
+            expected = previous;
+        }
+    }
+    barrier();
+
+    if (localIndex == 0u) {
+        atomicAdd(depositStatistics.deposits, groupDeposits);
+        atomicAdd(depositStatistics.binMerges, groupMerges);
+        atomicAdd(depositStatistics.globalAtomics, groupAtomics);
+        atomicAdd(depositStatistics.atomicConflicts, groupConflicts);
+    }
+}
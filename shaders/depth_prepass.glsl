@@ -0,0 +1,104 @@
+#version 430
+
+// One invocation per 8x8 tile of the screen
+layout(local_size_x = 8, local_size_y = 8, local_size_z = 1) in;
+
+#define USE_PYRAMID_SKIPPING
+
+#define USE_TRAIL_SAMPLER
+
+#define SIMULATION_SETTINGS
+
+#define OCCUPANCY_DATA
+
+layout(std430, binding = 1) buffer SettingsBuffer {
+    SimulationData settings;
+};
+
+layout(binding = 0, r32f) uniform image3D voxelData;
+
+#define TRAIL_ACCESS
+
+layout(rgba32f, binding = 1) uniform readonly image3D sdfData;
+
+#ifdef USE_PYRAMID_SKIPPING
+layout(binding = 1) uniform sampler3D trailPyramid;
+#endif
+
+// Distance along the rays of each tile that is known to be empty, read back by the full resolution renderers
+layout(r32f, binding = 7) uniform writeonly image2D depthPrepass;
+
+// Full resolution size, tiles on the right and top edges can be partial
+uniform vec2 screenSize;
+
+#define RAY_MARCHING
+
+const int DEPTH_PREPASS_TILE_SIZE = 8;
+const int CONE_MARCH_STEPS = 96;
+
+
+// Radius around a point in the grid known to hold no surface. The reduced SDF is pulled in by its cell size
+// on both ends (the point's cell and the seed's cell) and by the half size of a cube plus its smooth blend.
+float trail_free_distance(in vec3 point) {
+    int sdfReductionFactor = settings.sdf_reduction;
+    int reducedGridSize = settings.grid_size / sdfReductionFactor;
+    ivec3 searchPoint = clamp(ivec3(floor(point)) / sdfReductionFactor, ivec3(0), ivec3(reducedGridSize - 1));
+
+    float sdfDistance = imageLoad(sdfData, searchPoint).w;
+    return max(sdfDistance - float(2 * sdfReductionFactor - 1) * 1.732 - 0.75, 0.0);
+}
+
+// Radius around any point known to hold no surface. Outside the grid the nearest box point q splits it:
+// for every surface point v in the box |p - v|^2 >= |p - q|^2 + |q - v|^2.
+float safe_distance(in vec3 point, in vec3 gridMin, in vec3 gridMax) {
+    vec3 boxPoint = clamp(point, gridMin, gridMax);
+    float boxDistance = length(point - boxPoint);
+    float trailDistance = trail_free_distance(boxPoint);
+    return sqrt(boxDistance * boxDistance + trailDistance * trailDistance);
+}
+
+void main() {
+    ivec2 tile = ivec2(gl_GlobalInvocationID.xy);
+    if (any(greaterThanEqual(tile, imageSize(depthPrepass)))) {
+        return;
+    }
+
+    // Pixel rectangle of the tile, clipped to the screen
+    vec2 tileMin = vec2(tile * DEPTH_PREPASS_TILE_SIZE);
+    vec2 tileMax = min(tileMin + float(DEPTH_PREPASS_TILE_SIZE), screenSize);
+
+    // The cone follows the ray through the tile's center and opens wide enough to hold its corner rays
+    vec3 rayOrigin, axisDirection;
+    camera_ray((tileMin + tileMax) / screenSize - 1.0, rayOrigin, axisDirection);
+
+    float minCosine = 1.0;
+    for (int corner = 0; corner < 4; ++corner) {
+        vec2 cornerPixel = mix(tileMin, tileMax, vec2(corner & 1, corner >> 1));
+        vec3 cornerOrigin, cornerDirection;
+        camera_ray(cornerPixel / screenSize * 2.0 - 1.0, cornerOrigin, cornerDirection);
+        minCosine = min(minCosine, dot(axisDirection, cornerDirection));
+    }
+    float coneSlope = sqrt(max(1.0 - minCosine * minCosine, 0.0)) / max(minCosine, 1e-3); // tan of the half angle
+
+    vec3 offset = vec3(0.5); // offset to account for cube thickness
+    vec3 gridMin = vec3(0.0) - offset;
+    vec3 gridMax = vec3(settings.grid_size - 1) + offset;
+
+    // A ball around the axis at distance t with radius t * coneSlope holds every ray of the tile up to at least t
+    float t = 0.0;
+    const float MAXIMUM_TRACE_DISTANCE = length(settings.camera_position.xyz - settings.camera_focus.xyz) + settings.grid_size * 1.732;
+
+    for (int i = 0; i < CONE_MARCH_STEPS && t < MAXIMUM_TRACE_DISTANCE; ++i) {
+        float coneRadius = t * coneSlope;
+        float freeDistance = safe_distance(rayOrigin + axisDirection * t, gridMin, gridMax) - coneRadius;
+
+        if (freeDistance <= 0.01) {
+            break;
+        }
+
+        // Growing the ball with the cone: advance until the cone's edge reaches the free radius
+        t += freeDistance / (1.0 + coneSlope);
+    }
+
+    imageStore(depthPrepass, tile, vec4(t));
+}
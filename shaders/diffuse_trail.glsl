@@ -0,0 +1,71 @@
+#version 430
+
+#define WRAP_AROUND
+
+// Simulation Settings
+#define SIMULATION_SETTINGS
+
+#define TRAIL_DIFFUSION
+
+// Every work group owns 16 whole lines of the grid along the blurred axis, so it can blur them in place
+layout(local_size_x = DIFFUSION_LINES_PER_GROUP, local_size_y = DIFFUSION_LINES_PER_GROUP, local_size_z = 1) in;
+
+layout(binding = 0, r32f) uniform image3D voxelData;
+
+layout(std430, binding = 1) buffer SettingsBuffer {
+    SimulationData settings;
+};
+
+// Axis blurred by this dispatch, 0 x or 1 y. The z axis is blurred by decay_spores.glsl together with the decay.
+uniform int diffusionAxis;
+
+const int LINES_PER_GROUP = DIFFUSION_LINES_PER_GROUP;
+const int MAX_LINE_LENGTH = DIFFUSION_MAX_LINE_LENGTH;
+
+// Each voxel of the lines is loaded once, the whole line is the tile so the halo is the line's own far end
+shared float lines[LINES_PER_GROUP][MAX_LINE_LENGTH];
+
+
+void main() {
+    int gridSize = settings.grid_size;
+
+    // Along x the threads of a row walk one line, along y they sit on neighbouring lines,
+    // either way neighbouring invocations touch neighbouring voxels
+    int lineIndex = diffusionAxis == 0 ? int(gl_LocalInvocationID.y) : int(gl_LocalInvocationID.x);
+    int firstPosition = diffusionAxis == 0 ? int(gl_LocalInvocationID.x) : int(gl_LocalInvocationID.y);
+    int positionStride = diffusionAxis == 0 ? int(gl_WorkGroupSize.x) : int(gl_WorkGroupSize.y);
+
+    int line = int(gl_WorkGroupID.x) * LINES_PER_GROUP + lineIndex;
+    ivec3 lineStart = diffusionAxis == 0 ? ivec3(0, line, gl_WorkGroupID.y) : ivec3(line, 0, gl_WorkGroupID.y);
+    ivec3 lineStep = diffusionAxis == 0 ? ivec3(1, 0, 0) : ivec3(0, 1, 0);
+
+    // Lines past the grid still have to reach the barrier
+    bool validLine = line < gridSize;
+
+    if (validLine) {
+        for (int position = firstPosition; position < gridSize; position += positionStride) {
+            lines[lineIndex][position] = imageLoad(voxelData, lineStart + lineStep * position).x;
+        }
+    }
+    barrier();
+
+    // Three tap kernel per axis, the three axes together spread into all 26 neighbours
+    float sideWeight = clamp(settings.diffusion_rate * settings.delta_time, 0.0, 1.0) / 3.0;
+
+    if (validLine) {
+        for (int position = firstPosition; position < gridSize; position += positionStride) {
+            float center = lines[lineIndex][position];
+
+            #ifdef WRAP_AROUND
+            float before = lines[lineIndex][(position + gridSize - 1) % gridSize];
+            float after = lines[lineIndex][(position + 1) % gridSize];
+            #else
+            // Nothing flows out through the faces of the grid
+            float before = lines[lineIndex][max(position - 1, 0)];
+            float after = lines[lineIndex][min(position + 1, gridSize - 1)];
+            #endif
+
+            imageStore(voxelData, lineStart + lineStep * position, vec4(center + sideWeight * (before + after - 2.0 * center)));
+        }
+    }
+}
@@ -1,10 +1,16 @@
 #version 430
 
+#define USE_ENSEMBLE
+
+#define USE_SPORE_LIFECYCLE
+
 #define SPORE_STRUCT
 
 // Simulation Settings
 #define SIMULATION_SETTINGS
 
+#define OCCUPANCY_DATA
+
 layout(local_size_x = 8, local_size_y = 1, local_size_z = 1) in;
 
 layout(binding = 0, r32f) uniform image3D voxelData;
@@ -14,26 +20,46 @@ layout(std430, binding = 0) buffer SporesBuffer {
     Spore spores[];
 };
 
+#ifdef USE_ENSEMBLE
+#define ENSEMBLE_MEMBERS
+#else
 layout(std430, binding = 1) buffer SettingsBuffer {
     SimulationData settings;
 };
 
+// A single simulation fills the grid from its corner
+const ivec3 memberOrigin = ivec3(0);
+const uint memberFirstSpore = 0u;
+#endif
+
+#ifdef USE_SPORE_LIFECYCLE
+#define SPORE_POPULATION
+#else
+// Every spore of the settings is alive
+#define LIVE_SPORE_COUNT uint(settings.spore_count)
+#endif
+
 
 void main() {
     uint sporeID = gl_GlobalInvocationID.x;
 
+    #ifdef USE_ENSEMBLE
+    // One row of work groups per member
+    select_member(int(gl_GlobalInvocationID.y));
+    #endif
+
     // Check bounds
-    if (sporeID >= settings.spore_count) {
+    if (sporeID >= LIVE_SPORE_COUNT) {
         return;
     }
 
     int gridSize = settings.grid_size;
 
     // Get the spore position
-    vec3 sporePosition = spores[sporeID].position.xyz;
+    vec3 sporePosition = spores[memberFirstSpore + sporeID].position.xyz;
 
     // Determine the voxel grid coordinates closest to the spore position
-    ivec3 voxelCoord = ivec3(
+    ivec3 voxelCoord = memberOrigin + ivec3(
     clamp(int(floor(sporePosition.x)), 0, gridSize - 1),
     clamp(int(floor(sporePosition.y)), 0, gridSize - 1),
     clamp(int(floor(sporePosition.z)), 0, gridSize - 1)
@@ -41,4 +67,5 @@ void main() {
 
 
     imageStore(voxelData, voxelCoord, vec4(1.0)); // Mark the voxel as occupied by the spore
+    imageAtomicOr(occupancyData, occupancy_brick(voxelCoord), occupancy_bit(voxelCoord));
 }
@@ -0,0 +1,43 @@
+// Members of an ensemble, small simulations with their own settings that share one spore buffer and one trail atlas
+// so every pass runs all of them in a single dispatch. Injected through the ENSEMBLE_MEMBERS placeholder in place of
+// the settings buffer of a single simulation. All members have the same grid size and spore count, member m owns the
+// spores from m * spore_count on and the tile of the atlas in column m % tiles per row, row m / tiles per row.
+
+layout(std430, binding = 1) buffer SettingsBuffer {
+    SimulationData memberSettings[];
+};
+
+// Settings of the member this invocation works for, set by select_member
+SimulationData settings;
+// Corner of the member's tile in the atlas, spore positions stay relative to it
+ivec3 memberOrigin;
+uint memberFirstSpore;
+
+// The tiles fill the smallest square that holds every member, one tile deep. Counted from the square below the
+// member count so rounding in sqrt cannot add a row for perfect squares.
+int ensemble_tiles_per_row() {
+    return int(sqrt(float(memberSettings.length()) - 0.5)) + 1;
+}
+
+void select_member(in int member) {
+    int gridSize = memberSettings[0].grid_size;
+    int tilesPerRow = ensemble_tiles_per_row();
+
+    memberOrigin = ivec3(member % tilesPerRow, member / tilesPerRow, 0) * gridSize;
+    memberFirstSpore = uint(member) * uint(memberSettings[0].spore_count);
+
+    if (member < memberSettings.length()) {
+        settings = memberSettings[member];
+    } else {
+        // Tiles past the last member hold an empty grid, every bounds check fails
+        settings = memberSettings[0];
+        settings.grid_size = 0;
+        settings.spore_count = 0;
+    }
+}
+
+// Member whose tile holds a voxel of the atlas
+void select_member_at(in ivec3 atlasVoxel) {
+    ivec3 tile = atlasVoxel / memberSettings[0].grid_size;
+    select_member(tile.z == 0 ? tile.x + tile.y * ensemble_tiles_per_row() : memberSettings.length());
+}
@@ -5,13 +5,13 @@ layout(local_size_x = 8, local_size_y = 8, local_size_z = 8) in;
 // Simulation Settings
 #define SIMULATION_SETTINGS
 
+#define OCCUPANCY_DATA
+
 
 layout(std430, binding = 1) buffer SettingsBuffer {
     SimulationData settings;
 };
 
-layout(binding = 0, r32f) uniform image3D voxelData;
-
 // Using image3D for SDF data
 layout(rgba32f, binding = 1) uniform writeonly image3D sdfData;
 
@@ -43,24 +43,10 @@ void main() {
     // Initialize the SDF cell with "infinite" distance
     vec4 sdfEntry = vec4(reducedGridPos * sdfReductionFactor, 1e6);
 
-    // Search within the corresponding high-resolution area
-    for (int z = highGridStart.z; z <= highGridEnd.z; ++z) {
-        for (int y = highGridStart.y; y <= highGridEnd.y; ++y) {
-            for (int x = highGridStart.x; x <= highGridEnd.x; ++x) {
-                // Compute 1D index for the high-resolution voxel grid
-                int highIndex = x + settings.grid_size * (y + settings.grid_size * z);
-
-                // Check if the voxel is filled
-                if (imageLoad(voxelData, ivec3(x,y,z)).x > 0.0) {
-
-                    // Mark the reduced grid cell as having a value
-                    sdfEntry = vec4(reducedGridPos * sdfReductionFactor, 0.0);
-                    break; // Exit the loop early if any voxel is filled
-                }
-            }
-            if (sdfEntry.w == 0.0) break; // Exit the outer loop early
-        }
-        if (sdfEntry.w == 0.0) break; // Exit the outer loop early
+    // Search the occupancy bricks of the corresponding high-resolution area, one word covers 32 voxels
+    if (!is_region_empty(highGridStart, highGridEnd)) {
+        // Mark the reduced grid cell as having a value
+        sdfEntry.w = 0.0;
     }
 
     // TODO: Remove, this is for testing
@@ -2,6 +2,16 @@
 
 #define WRAP_AROUND
 
+#define USE_TRAIL_SAMPLER
+
+#define USE_TRILINEAR_SENSING
+
+#define USE_LOD_SENSING
+
+#define USE_ENSEMBLE
+
+#define USE_SPORE_LIFECYCLE
+
 #define SPORE_STRUCT
 
 // Simulation Settings
@@ -14,26 +24,64 @@ layout(std430, binding = 0) buffer SporesBuffer {
     Spore spores[];
 };
 
+#ifdef USE_ENSEMBLE
+#define ENSEMBLE_MEMBERS
+#else
 layout(std430, binding = 1) buffer SettingsBuffer {
     SimulationData settings;
 };
 
+// A single simulation fills the grid from its corner
+const ivec3 memberOrigin = ivec3(0);
+const uint memberFirstSpore = 0u;
+#endif
+
+#ifdef USE_SPORE_LIFECYCLE
+#define SPORE_POPULATION
+#else
+// Every spore of the settings is alive
+#define LIVE_SPORE_COUNT uint(settings.spore_count)
+#endif
+
 layout(binding = 0, r32f) uniform image3D voxelData;
 
+#define TRAIL_ACCESS
+
+#ifdef USE_LOD_SENSING
+#define TRAIL_LOD
+
+// Sensors reaching further than this read the mean of a 2x2x2 cell, each doubling of the reach doubles the cell
+const float LOD_SENSING_DISTANCE = 16.0;
+#endif
+
 float sense(vec3 position, vec3 direction, int gridSize, float sensorDistance) {
     // Calculate the sampling position
     vec3 samplePosition = position + normalize(direction) * sensorDistance;
 
-    // Clamp the sampling position to the grid boundaries
     #ifdef WRAP_AROUND
     // Wrap the sampling position to the grid boundaries
-    ivec3 sensorPosition = ivec3(mod(samplePosition + float(settings.grid_size), float(settings.grid_size)));
+    vec3 gridPosition = mod(samplePosition + float(settings.grid_size), float(settings.grid_size));
     #else
     // Clamp to the grid boundaries
-    ivec3 sensorPosition = ivec3(clamp(samplePosition, vec3(0.0), vec3(gridSize - 1)));
+    vec3 gridPosition = clamp(samplePosition, vec3(0.0), vec3(gridSize - 1));
+    #endif
+
+    #ifdef USE_LOD_SENSING
+    // Far sensors see the trail in a region that grows with their reach rather than a single distant voxel
+    if (sensorDistance > LOD_SENSING_DISTANCE) {
+        return sample_trail_lod(gridPosition, log2(sensorDistance / LOD_SENSING_DISTANCE) + 1.0, gridSize);
+    }
     #endif
+
+    #ifdef USE_TRILINEAR_SENSING
+    // Voxel i is centred on i + 0.5 in spore space. Kept half a voxel inside the grid so the filter never
+    // blends in texels past grid_size, which still hold trail from a larger grid.
+    vec3 filteredPosition = clamp(gridPosition, vec3(0.5), vec3(gridSize - 0.5));
+    return texture(trailTexture, (vec3(memberOrigin) + filteredPosition) / vec3(textureSize(trailTexture, 0))).x;
+    #else
     // Return the voxel data at the sampled position
-    return imageLoad(voxelData, sensorPosition).x;
+    return load_trail(memberOrigin + ivec3(gridPosition));
+    #endif
 }
 
 // Creating overload so that when it isn't used, it will be removed by compiler and there won't be if checks normally
@@ -50,10 +98,10 @@ float sense(vec3 position, vec3 direction, int gridSize, float sensorDistance, b
     #endif
 
     if (debug){
-        imageStore(voxelData, sensorPosition, vec4(0.5));
+        imageStore(voxelData, memberOrigin + sensorPosition, vec4(0.5));
     }
     // Return the voxel data at the sampled position
-    return imageLoad(voxelData, sensorPosition).x;
+    return imageLoad(voxelData, memberOrigin + sensorPosition).x;
 }
 
 // Function to keep orientation matrix orthogonal
@@ -79,12 +127,17 @@ mat3 rotateOrientation(mat3 orientation, vec3 axis, float angle) {
 void main() {
     uint sporeID = gl_GlobalInvocationID.x;
 
+    #ifdef USE_ENSEMBLE
+    // One row of work groups per member
+    select_member(int(gl_GlobalInvocationID.y));
+    #endif
+
     // Check bounds
-    if (sporeID >= settings.spore_count) {
+    if (sporeID >= LIVE_SPORE_COUNT) {
         return;
     }
 
-    Spore spore = spores[sporeID];
+    Spore spore = spores[memberFirstSpore + sporeID];
     vec3 sporePosition = spore.position.xyz;
 
     vec3 forward = spore.orientation[2];
@@ -168,5 +221,5 @@ void main() {
     spore.position = vec4(newPosition, 0.0);
 
     // Write the updated spore back to the buffer
-    spores[sporeID] = spore;
+    spores[memberFirstSpore + sporeID] = spore;
 }
@@ -0,0 +1,89 @@
+#version 430
+
+// One work group per texel of the projection, its invocations stride along the voxel column behind it
+// and combine their partial results in shared memory
+layout(local_size_x = 64, local_size_y = 1, local_size_z = 1) in;
+
+#define USE_ENSEMBLE
+
+#define SIMULATION_SETTINGS
+
+#ifdef USE_ENSEMBLE
+// The ensemble's atlas is only looked at along z, which puts every member's tile side by side
+#define ENSEMBLE_MEMBERS
+#else
+layout(std430, binding = 1) buffer SettingsBuffer {
+    SimulationData settings;
+};
+#endif
+
+layout(binding = 0, r32f) uniform readonly image3D voxelData;
+
+layout(r32f, binding = 5) uniform writeonly image2D projectionImage;
+
+// Axis the view looks along, 0 x, 1 y, 2 z
+uniform int projectionAxis;
+// 0 maximum, 1 sum divided by the column length (an average), 2 a single slice
+uniform int projectionKind;
+// Voxel layer along the axis shown by the slice
+uniform int sliceIndex;
+
+const int PROJECTION_KIND_MAXIMUM = 0;
+const int PROJECTION_KIND_SUM = 1;
+const int PROJECTION_KIND_SLICE = 2;
+
+shared float partialResults[64];
+
+
+// Voxel at the given depth behind an image texel. Side views put z across and y up, the top view x across and z up.
+ivec3 column_voxel(in ivec2 texel, in int depth) {
+    if (projectionAxis == 0) {
+        return ivec3(depth, texel.y, texel.x);
+    }
+    if (projectionAxis == 1) {
+        return ivec3(texel.x, depth, texel.y);
+    }
+    return ivec3(texel, depth);
+}
+
+void main() {
+    ivec2 texel = ivec2(gl_WorkGroupID.xy);
+    uint lane = gl_LocalInvocationID.x;
+
+    #ifdef USE_ENSEMBLE
+    select_member_at(ivec3(texel, 0));
+    #endif
+    int gridSize = settings.grid_size;
+
+    float result = 0.0;
+    if (projectionKind == PROJECTION_KIND_SLICE) {
+        if (lane == 0u && gridSize > 0) {
+            result = imageLoad(voxelData, column_voxel(texel, clamp(sliceIndex, 0, gridSize - 1))).x;
+        }
+    } else {
+        for (int depth = int(lane); depth < gridSize; depth += 64) {
+            float voxelValue = imageLoad(voxelData, column_voxel(texel, depth)).x;
+            result = projectionKind == PROJECTION_KIND_SUM ? result + voxelValue : max(result, voxelValue);
+        }
+    }
+
+    partialResults[lane] = result;
+    barrier();
+
+    // Tree reduction, half the invocations fold the other half in each round
+    for (uint stride = 32u; stride > 0u; stride >>= 1) {
+        if (lane < stride) {
+            float other = partialResults[lane + stride];
+            partialResults[lane] = projectionKind == PROJECTION_KIND_MAXIMUM ? max(partialResults[lane], other) : partialResults[lane] + other;
+        }
+        barrier();
+    }
+
+    if (lane == 0u) {
+        float projected = partialResults[0];
+        if (projectionKind == PROJECTION_KIND_SUM) {
+            projected /= float(gridSize);
+        }
+        imageStore(projectionImage, texel, vec4(projected));
+    }
+}
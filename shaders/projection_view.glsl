@@ -0,0 +1,42 @@
+#type vertex
+#version 430 core
+
+out vec2 uv;
+
+void main() {
+    // One triangle covering the screen, no vertex buffer needed
+    vec2 corner = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    gl_Position = vec4(corner * 2.0 - 1.0, 0.0, 1.0);
+    uv = corner;
+}
+
+#type fragment
+#version 430 core
+
+in vec2 uv;
+
+out vec4 fragmentColor;
+
+// Projection or slice of the trail from project_trail.glsl
+layout(binding = 6) uniform sampler2D projectionImage;
+
+// Multiplies the projected values before the colour ramp
+uniform float exposure;
+
+// Fraction of the window the square image covers along each axis, the rest is letterboxed
+uniform vec2 viewScale;
+
+// Black through red and yellow to white, TrailProjection::heatColor is the same ramp for thumbnails
+vec3 heat_color(in float value) {
+    return clamp(vec3(value * 3.0, value * 3.0 - 1.0, value * 3.0 - 2.0), 0.0, 1.0);
+}
+
+void main() {
+    vec2 imageUV = (uv - 0.5) / viewScale + 0.5;
+    if (any(lessThan(imageUV, vec2(0.0))) || any(greaterThan(imageUV, vec2(1.0)))) {
+        fragmentColor = vec4(0.0, 0.0, 0.0, 1.0);
+        return;
+    }
+
+    fragmentColor = vec4(heat_color(texture(projectionImage, imageUV).x * exposure), 1.0);
+}
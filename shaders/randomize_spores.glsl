@@ -1,10 +1,14 @@
 #version 430
 
+#define USE_ENSEMBLE
+
 #define SPORE_STRUCT
 
 // Simulation Settings
 #define SIMULATION_SETTINGS
 
+#define RANDOM_NUMBERS
+
 layout(local_size_x = 8, local_size_y = 1, local_size_z = 1) in;
 
 // Buffers
@@ -12,52 +16,45 @@ layout(std430, binding = 0) buffer SporesBuffer {
     Spore spores[];
 };
 
+#ifdef USE_ENSEMBLE
+#define ENSEMBLE_MEMBERS
+#else
 layout(std430, binding = 1) buffer SettingsBuffer {
     SimulationData settings;
 };
 
-float random(vec2 st) {
-    return fract(sin(dot(st.xy, vec2(12.9898, 78.233))) * 43758.5453123);
-}
+// A single simulation fills the grid from its corner
+const ivec3 memberOrigin = ivec3(0);
+const uint memberFirstSpore = 0u;
+#endif
 
 void main() {
     uint sporeID = gl_GlobalInvocationID.x;
 
+    #ifdef USE_ENSEMBLE
+    // One row of work groups per member, the draws ignore the member so members with the same seed start from the same spores
+    select_member(int(gl_GlobalInvocationID.y));
+    #endif
+
     // Check bounds
     if (sporeID >= settings.spore_count) {
         return;
     }
 
-    Spore spore = spores[sporeID];
+    Spore spore = spores[memberFirstSpore + sporeID];
 
-    // Randomize position
-    vec2 seed = vec2(float(sporeID) / settings.spore_count, fract(float(sporeID) * float(0.17)));
+    uint seed = uint(settings.seed);
 
+    // One correctly rounded product per axis, positions are bit-identical to a CPU run with the same seed
     spore.position = vec4(
-    random(seed) * float(settings.grid_size),
-    random(seed + vec2(0.1, 0.2)) * float(settings.grid_size),
-    random(seed + vec2(0.2, 0.3)) * float(settings.grid_size),
+    random_unit(seed, sporeID, SPORE_DRAW_POSITION) * float(settings.grid_size),
+    random_unit(seed, sporeID, SPORE_DRAW_POSITION + 1u) * float(settings.grid_size),
+    random_unit(seed, sporeID, SPORE_DRAW_POSITION + 2u) * float(settings.grid_size),
     0.0);
 
     // Randomize orientation (yaw and pitch)
-    float randomYaw = random(seed + vec2(0.3, 0.4)) * 2.0 * 3.14159265359;   // Yaw in [0, 2π]
-    float randomPitch = random(seed + vec2(0.4, 0.5)) * 3.14159265359; // Pitch in [0, π]
-
-    // Compute rotation matrices
-    mat3 yawRotation = mat3(
-    vec3(cos(randomYaw), 0.0, -sin(randomYaw)),
-    vec3(0.0, 1.0, 0.0),
-    vec3(sin(randomYaw), 0.0, cos(randomYaw))
-    );
-
-    mat3 pitchRotation = mat3(
-    vec3(1.0, 0.0, 0.0),
-    vec3(0.0, cos(randomPitch), sin(randomPitch)),
-    vec3(0.0, -sin(randomPitch), cos(randomPitch))
-    );
-
-    spore.orientation = pitchRotation * yawRotation;
+    spore.orientation = random_orientation(seed, sporeID);
 
     // Write the updated spore back to the buffer
-    spores[sporeID] = spore;
+    spores[memberFirstSpore + sporeID] = spore;
 }
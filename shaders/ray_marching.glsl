@@ -0,0 +1,462 @@
+// Ray marching shared by the fragment (renderer.glsl) and compute (render_compute.glsl) renderers.
+// Injected through the RAY_MARCHING placeholder, expects settings, load_trail, sdfData, with
+// USE_PYRAMID_SKIPPING trailPyramid, with USE_BAKED_DENSITY bakedDensity and with USE_TRAIL_LOD sample_trail_lod
+// (trail_lod.glsl) to be declared by the including shader.
+
+#ifndef USE_MARCH_STATISTICS
+// Cost counters from MarchStatistics.h, nothing to count without the variant
+#define COUNT_MARCH_STEP()
+#define COUNT_TEXEL_FETCHES(count)
+#endif
+
+vec3 lightColor = vec3(1.0, 1.0, 1.0);    // Pure white light
+vec3 objectColor = vec3(0.0, 1.0, 0.2);   // Reddish object
+
+float maxCubeSideLength = 1.0;
+
+// Calculate the distance from a point to a cube centered at `c` with size `s`
+float distance_from_cube(in vec3 point, in vec3 center, in float sideLength) {
+    vec3 d = abs(point - center) - vec3(mix(0, maxCubeSideLength, sideLength) * 0.5f);
+    return length(max(d, 0.0)) + min(max(d.x, max(d.y, d.z)), 0.0);
+}
+
+float distance_from_sphere(in vec3 point, in vec3 center, in float radius) {
+    // Distance from center minus the sphere radius
+    return length(point - center) - radius;
+}
+
+float distance_from_rounded_cube(in vec3 point, in vec3 center, in float sideLength, float radius) {
+    // Compute the half-size of the cube
+    float halfSize = mix(0, maxCubeSideLength, sideLength) * 0.5;
+
+    // Distance to the surface of the box minus the rounding radius
+    vec3 d = abs(point - center) - vec3(halfSize - radius);
+    return length(max(d, 0.0)) - radius;
+}
+
+float smooth_min(float a, float b, float k) {
+    float h = max(k - abs(a - b), 0.0) / k;
+    return min(a, b) - h * h * k * 0.25;
+}
+
+float smooth_max(float a, float b, float k) {
+    float h = max(k - abs(a - b), 0.0) / k;
+    return max(a, b) + h * h * k * 0.25;
+}
+
+// Smooth-min blend of the cubes of every voxel in the box [searchMin, searchMax] (inclusive), 1e6 when all are empty
+float smooth_voxel_blend(in vec3 point, in ivec3 searchMin, in ivec3 searchMax) {
+    float result = 1e6;
+
+    // Iterate only within a cube around the ray's current position
+    for (int x = searchMin.x; x <= searchMax.x; x++) {
+        for (int y = searchMin.y; y <= searchMax.y; y++) {
+            for (int z = searchMin.z; z <= searchMax.z; z++) {
+                float voxelValue =  load_trail(ivec3(x, y, z));
+                COUNT_TEXEL_FETCHES(1);
+
+                // Skip zero-sized cubes
+                if (voxelValue <= 0.01) continue;
+
+                // Calculate the grid position
+                vec3 gridPoint = vec3(float(x), float(y), float(z));
+
+                // Calculate the distance to the cube at this grid point
+                float cube = distance_from_cube(point, gridPoint, voxelValue);
+
+                // Combine distances using smooth_min for blending
+                result = smooth_min(result, cube, 0.55);
+            }
+        }
+    }
+
+    return result;
+}
+
+#ifdef USE_BAKED_DENSITY
+// Interpolating between voxel centres rounds off the cube corners and thins single voxel trails, pushes the surface back out
+const float BAKED_DENSITY_BIAS = 0.2;
+#endif
+
+float map_the_world(in vec3 point) {
+    float result = 1e6; // Start with a very large value (infinite distance)
+    const int searchRadius = 1; // Local cube radius (adjustable)
+
+    // Convert point to grid coordinates
+    ivec3 center = ivec3(floor(point));
+
+    int sdfReductionFactor = settings.sdf_reduction;
+
+    ivec3 searchPoint = center / sdfReductionFactor;
+    vec4 sdfValue = imageLoad(sdfData, searchPoint);
+    COUNT_TEXEL_FETCHES(1);
+
+    float cameraSDF = distance_from_sphere(point, settings.camera_position.xyz, float(settings.grid_size) / 4.0);
+
+    // skip this if the closest cube is less than the max betwen the search radius and the reduction factor times by the diagonal of the cube to make sure it will account for diagonal movement.
+    if (sdfValue.w > max(sdfReductionFactor, searchRadius) * 1.8) {
+        // subtract a bit off to make sure we do not overshoot
+        result = sdfValue.w - sdfReductionFactor / 2.0;
+        result = min(result, settings.grid_size / 2.0); // make sure it jumps no more than half the grid at one point to account for sdf values not set
+        result = max(result, -cameraSDF);
+        return result;
+    }
+
+#ifdef USE_BAKED_DENSITY
+    // One trilinear fetch of the blend bake_density.glsl evaluated at every voxel centre
+    result = texture(bakedDensity, (point + 0.5) / vec3(textureSize(bakedDensity, 0))).x - BAKED_DENSITY_BIAS;
+    COUNT_TEXEL_FETCHES(1);
+#else
+    ivec3 searchMin = max(center - searchRadius, ivec3(0));
+    ivec3 searchMax = min(center + searchRadius, ivec3(settings.grid_size - 1));
+
+    // The coarse SDF only knows a cell nearby is filled, the occupancy bits tell if this neighbourhood is
+    COUNT_TEXEL_FETCHES((occupancy_brick(searchMax).x - occupancy_brick(searchMin).x + 1) *
+                        (occupancy_brick(searchMax).y - occupancy_brick(searchMin).y + 1) *
+                        (occupancy_brick(searchMax).z - occupancy_brick(searchMin).z + 1));
+    if (is_region_empty(searchMin, searchMax)) {
+        return max(float(searchRadius), -cameraSDF);
+    }
+
+    result = smooth_voxel_blend(point, searchMin, searchMax);
+
+    // Moves search radius if nothing has been encountered.
+    result = min(searchRadius, result);
+#endif
+    result = max(result, -cameraSDF);
+    return result; // Return the minimum distance for the scene
+}
+
+// Distance the ray can travel from point (inside voxel) without entering an occupied voxel. The reduced SDF
+// is pulled in by its cell size on both ends and by the half diagonal of a voxel, and clipped by the camera sphere.
+float transparent_skip_distance(in vec3 point, in ivec3 voxel) {
+    int sdfReductionFactor = settings.sdf_reduction;
+    int reducedGridSize = settings.grid_size / sdfReductionFactor;
+
+    vec4 sdfValue = imageLoad(sdfData, clamp(voxel / sdfReductionFactor, ivec3(0), ivec3(reducedGridSize - 1)));
+    COUNT_TEXEL_FETCHES(1);
+    return sdfValue.w - float(2 * sdfReductionFactor - 1) * 1.732 - 0.866;
+}
+
+#ifdef USE_PYRAMID_SKIPPING
+// Stop this far before the wall of an empty cell, the smooth blend of the neighbouring cubes reaches slightly into it
+const float PYRAMID_SKIP_MARGIN = 0.25;
+
+// Distance the ray can travel through empty pyramid cells from point. Descends from the coarsest level
+// until it finds an empty cell, 0 when even the finest cell around the point holds trail.
+float pyramid_skip_distance(in vec3 point, in vec3 rayDirection) {
+    // Voxel i owns [i - 0.5, i + 0.5), so cell walls sit half a voxel below their first voxel
+    vec3 voxelPoint = point + 0.5;
+
+    for (int level = textureQueryLevels(trailPyramid) - 1; level >= 0; --level) {
+        float cellSize = float(2 << level);
+        ivec3 cell = ivec3(floor(voxelPoint / cellSize));
+
+        if (any(lessThan(cell, ivec3(0))) || any(greaterThanEqual(cell, textureSize(trailPyramid, level)))) {
+            return 0.0;
+        }
+
+        // Same threshold map_the_world uses to ignore a voxel
+        COUNT_TEXEL_FETCHES(1);
+        if (texelFetch(trailPyramid, cell, level).y <= 0.01) {
+            vec3 cellMin = vec3(cell) * cellSize - 0.5;
+            vec3 exitWalls = cellMin + step(0.0, rayDirection) * cellSize;
+            vec3 exitDistances = (exitWalls - point) / rayDirection;
+            return min(exitDistances.x, min(exitDistances.y, exitDistances.z));
+        }
+    }
+
+    return 0.0;
+}
+#endif
+
+// Calculate the normal at a point on the surface
+vec3 calculate_normal(in vec3 point) {
+#ifdef USE_BAKED_DENSITY
+    // Four taps on a tetrahedron, the trilinear field is only piecewise smooth so the offset spans part of a voxel
+    const float EPSILON = 0.25;
+    const vec2 k = vec2(1.0, -1.0);
+    return normalize(k.xyy * map_the_world(point + k.xyy * EPSILON) +
+                     k.yyx * map_the_world(point + k.yyx * EPSILON) +
+                     k.yxy * map_the_world(point + k.yxy * EPSILON) +
+                     k.xxx * map_the_world(point + k.xxx * EPSILON));
+#else
+    const float EPSILON = 0.01;
+    float dx = map_the_world(point + vec3(EPSILON, 0.0, 0.0)) - map_the_world(point - vec3(EPSILON, 0.0, 0.0));
+    float dy = map_the_world(point + vec3(0.0, EPSILON, 0.0)) - map_the_world(point - vec3(0.0, EPSILON, 0.0));
+    float dz = map_the_world(point + vec3(0.0, 0.0, EPSILON)) - map_the_world(point - vec3(0.0, 0.0, EPSILON));
+    return normalize(vec3(dx, dy, dz));
+#endif
+}
+
+vec3 calculage_lighting(in vec3 rayOrigin, in vec3 current_position) {
+    // Calculate normal at the hit point
+    vec3 normal = calculate_normal(current_position);
+    vec3 lightPosition = vec3(-5, settings.grid_size * 1.5f, -5); // Light above and slightly to the side
+
+    // Calculate lighting
+    vec3 lightDir = normalize(lightPosition - current_position); // Direction to light
+    float diff = max(dot(normal, lightDir), 0.0); // Lambertian (diffuse) term
+
+    // Calculate view direction
+    vec3 viewDir = normalize(rayOrigin - current_position);
+
+    // Combine light contributions
+    vec3 ambient = 0.1 * lightColor; // Ambient lighting
+    vec3 diffuse = diff * lightColor; // Diffuse lighting
+
+    vec3 light = diffuse + ambient ; // Combine all light components
+
+    vec3 gradient = current_position / vec3(settings.grid_size);
+
+    return gradient; // Multiply by object color
+}
+
+// Distance from the ray origin to the surface the last ray_march call hit, -1 when it missed
+float rayMarchHitDistance = -1.0;
+
+// Perform ray marching to find intersections with the scene
+vec3 ray_march(in vec3 rayOrigin, in vec3 rayDirection) {
+    float total_distance_traveled = 0.0;
+    rayMarchHitDistance = -1.0;
+    const int NUMBER_OF_STEPS = 500;
+    const float MINIMUM_HIT_DISTANCE = 0.1;
+    // Diagonal of a cube side length * sqrt(3)
+    const float MAXIMUM_TRACE_DISTANCE = settings.grid_size * 1.732;
+
+    for (int i = 0; i < NUMBER_OF_STEPS; ++i) {
+        vec3 current_position = rayOrigin + total_distance_traveled * rayDirection;
+        COUNT_MARCH_STEP();
+
+        // If traveled too far, or exited the bounds, return red (for now)
+        if (total_distance_traveled > MAXIMUM_TRACE_DISTANCE || distance_from_cube(current_position, settings.camera_focus.xyz, settings.grid_size) > 1) {
+            return vec3(i / float(NUMBER_OF_STEPS), 0.0, 0.0);
+        }
+
+        #ifdef USE_PYRAMID_SKIPPING
+        // Jump through empty space in large steps, only sphere trace where the pyramid says there is trail
+        float skipDistance = pyramid_skip_distance(current_position, rayDirection) - PYRAMID_SKIP_MARGIN;
+        if (skipDistance > 0.0) {
+            total_distance_traveled += skipDistance;
+            continue;
+        }
+        #endif
+
+        float distance_to_closest = map_the_world(current_position);
+//        return vec3(distance_to_closest);
+
+        if (distance_to_closest < MINIMUM_HIT_DISTANCE) {
+            rayMarchHitDistance = total_distance_traveled;
+            return calculage_lighting(rayOrigin, current_position);
+        }
+
+        total_distance_traveled += distance_to_closest;
+    }
+    return vec3(0.0); // Background color (black)
+}
+
+// Amanatides-Woo traversal: every voxel the ray crosses is visited once and adds opacity for the length
+// of ray inside it. Empty occupancy bricks, and the stretches the SDF (or the pyramid) knows to be empty beyond them,
+// are jumped over, restarting the walk after them.
+// Opacity per voxel length is tuned to the old fixed step of 0.75 * sdf_reduction at the default reduction of 2
+const float OPACITY_REFERENCE_LENGTH = 1.5;
+
+#ifdef USE_TRAIL_LOD
+// Distance from the camera where transparent rays leave the voxel walk for 2x2x2 cells, every doubling of it
+// moves them one level up the mean trail chain
+uniform float trailLodDistance;
+
+// Rest of a transparent ray from t on, one step per cell of the level for its distance from the camera. The mean
+// trail of a cell times the length through it gives on average the opacity the voxel walk would have summed.
+vec3 ray_march_trail_lod(in vec3 rayOrigin, in vec3 rayDirection, in float t, in vec3 opacity_accumulator) {
+    // Every step crosses at least two voxels
+    const int MAXIMUM_ITERATIONS = settings.grid_size + 64;
+    const float MAXIMUM_TRACE_DISTANCE = settings.grid_size * 1.732;
+
+    float opacity_scaler = 15.0 / (float(settings.grid_size));
+    float cameraCutoutRadius = float(settings.grid_size) / 4.0;
+    float coarsestLevel = float(textureQueryLevels(trailLod));
+
+    for (int i = 0; i < MAXIMUM_ITERATIONS; ++i) {
+        vec3 current_position = rayOrigin + t * rayDirection;
+        COUNT_MARCH_STEP();
+
+        // Rays start a hair in front of the grid, so outside only ends the march once they have been in it
+        bool outsideGrid = any(lessThan(current_position, vec3(-0.5))) ||
+                           any(greaterThan(current_position, vec3(settings.grid_size) - 0.5));
+        if ((outsideGrid && t > 1.0) || t > MAXIMUM_TRACE_DISTANCE) {
+            break;
+        }
+
+        float cameraDistance = distance(current_position, settings.camera_position.xyz);
+        float level = clamp(log2(cameraDistance / trailLodDistance) + 1.0, 1.0, coarsestLevel);
+        float cellSize = exp2(level);
+
+        // Empty space further than a cell is skipped with the SDF like the voxel walk does
+        float skipDistance = transparent_skip_distance(current_position, ivec3(floor(current_position + 0.5)));
+        if (skipDistance > cellSize) {
+            t += skipDistance;
+            continue;
+        }
+
+        // The mean is taken halfway through the step
+        vec3 cellPosition = current_position + rayDirection * (cellSize * 0.5);
+        float trailMean = sample_trail_lod(cellPosition + 0.5, level, settings.grid_size);
+        COUNT_TEXEL_FETCHES(1);
+        t += cellSize;
+
+        // The camera sphere is cut out of the grid so the inside stays visible when zoomed in
+        if (trailMean <= 0.0 || distance_from_sphere(cellPosition, settings.camera_position.xyz, cameraCutoutRadius) < 0.0) {
+            continue;
+        }
+
+        float opacity_amount = trailMean * opacity_scaler * cellSize / OPACITY_REFERENCE_LENGTH;
+        opacity_accumulator += (cellPosition / float(settings.grid_size)) * opacity_amount;
+
+        // Opacity is full, nothing behind can show through
+        if (max(opacity_accumulator.x, max(opacity_accumulator.y, opacity_accumulator.z)) >= 1.0f) {
+            break;
+        }
+    }
+
+    return opacity_accumulator;
+}
+#endif
+
+vec3 ray_march_transparency(in vec3 rayOrigin, in vec3 rayDirection) {
+    // Visiting every voxel along the grid diagonal, plus room for the jumps
+    const int MAXIMUM_ITERATIONS = settings.grid_size * 3 + 64;
+    // Diagonal of a cube side length * sqrt(3)
+    const float MAXIMUM_TRACE_DISTANCE = settings.grid_size * 1.732;
+
+    vec3 opacity_accumulator = vec3(0.0); // Initialize as a vec3 to accumulate color
+    float opacity_scaler = 15.0 / (float(settings.grid_size));
+    float cameraCutoutRadius = float(settings.grid_size) / 4.0;
+
+    // Voxel i owns [i - 0.5, i + 0.5), walls are offset by half a voxel from the integer grid
+    ivec3 voxelStep = ivec3(sign(rayDirection));
+    vec3 tDelta = abs(1.0 / rayDirection);
+
+    float t = 0.0;
+    ivec3 voxel = ivec3(0);
+    vec3 tNext = vec3(0.0);
+    bool restartWalk = true;
+
+    ivec3 cachedBrick = ivec3(-1);
+    uint brickWord = 0u;
+
+    for (int i = 0; i < MAXIMUM_ITERATIONS; ++i) {
+        vec3 current_position = rayOrigin + t * rayDirection;
+        COUNT_MARCH_STEP();
+
+        #ifdef USE_TRAIL_LOD
+        // The distance from the camera only grows along the ray, once past the LOD distance the rest is coarse
+        if (distance(current_position, settings.camera_position.xyz) >= trailLodDistance) {
+            return ray_march_trail_lod(rayOrigin, rayDirection, t, opacity_accumulator);
+        }
+        #endif
+
+        if (restartWalk) {
+            voxel = ivec3(floor(current_position + 0.5));
+            tNext = (vec3(voxel) + step(0.0, rayDirection) - 0.5 - rayOrigin) / rayDirection;
+            restartWalk = false;
+        }
+
+        // Rays start a hair in front of the grid, so outside only ends the walk once they have been in it
+        bool outsideGrid = any(lessThan(voxel, ivec3(0))) || any(greaterThanEqual(voxel, ivec3(settings.grid_size)));
+        if ((outsideGrid && t > 1.0) || t > MAXIMUM_TRACE_DISTANCE) {
+            break;
+        }
+
+        // One occupancy word covers a brick of voxels, only voxels with their bit set are fetched
+        ivec3 brick = occupancy_brick(voxel);
+        if (brick != cachedBrick) {
+            cachedBrick = brick;
+            brickWord = outsideGrid ? 0u : imageLoad(occupancyData, brick).x;
+            COUNT_TEXEL_FETCHES(outsideGrid ? 0 : 1);
+        }
+
+        if (brickWord == 0u && !outsideGrid) {
+            // Empty brick, jump to its far wall or further when the SDF (or the pyramid) allows it
+            vec3 brickMin = vec3(brick * OCCUPANCY_BRICK_SIZE) - 0.5;
+            vec3 exitWalls = brickMin + step(0.0, rayDirection) * vec3(OCCUPANCY_BRICK_SIZE);
+            vec3 exitDistances = (exitWalls - current_position) / rayDirection;
+
+            float skipDistance = max(min(exitDistances.x, min(exitDistances.y, exitDistances.z)),
+                                     transparent_skip_distance(current_position, voxel));
+            #ifdef USE_PYRAMID_SKIPPING
+            skipDistance = max(skipDistance, pyramid_skip_distance(current_position, rayDirection) - PYRAMID_SKIP_MARGIN);
+            #endif
+
+            // Just past the wall, so the walk restarts in the next brick
+            t += max(skipDistance, 0.0) + 0.001;
+            restartWalk = true;
+            continue;
+        }
+
+        float voxelValue = (brickWord & occupancy_bit(voxel)) != 0u ? load_trail(voxel) : 0.0;
+        COUNT_TEXEL_FETCHES((brickWord & occupancy_bit(voxel)) != 0u ? 1 : 0);
+
+        // Length of the ray inside this voxel, then step across the nearest wall
+        ivec3 currentVoxel = voxel;
+        float tExit;
+        if (tNext.x < tNext.y && tNext.x < tNext.z) {
+            tExit = tNext.x;
+            tNext.x += tDelta.x;
+            voxel.x += voxelStep.x;
+        } else if (tNext.y < tNext.z) {
+            tExit = tNext.y;
+            tNext.y += tDelta.y;
+            voxel.y += voxelStep.y;
+        } else {
+            tExit = tNext.z;
+            tNext.z += tDelta.z;
+            voxel.z += voxelStep.z;
+        }
+
+        float segmentLength = max(tExit - t, 0.0);
+        t = tExit;
+
+        // The camera sphere is cut out of the grid so the inside stays visible when zoomed in
+        if (voxelValue <= 0.0 || distance_from_sphere(current_position, settings.camera_position.xyz, cameraCutoutRadius) < 0.0) {
+            continue;
+        }
+
+        float opacity_amount = voxelValue * opacity_scaler * segmentLength / OPACITY_REFERENCE_LENGTH;
+        opacity_accumulator += (vec3(currentVoxel) / float(settings.grid_size)) * opacity_amount;
+
+        // Opacity is full, nothing behind can show through
+        if (max(opacity_accumulator.x, max(opacity_accumulator.y, opacity_accumulator.z)) >= 1.0f) {
+            break;
+        }
+    }
+
+    return opacity_accumulator;
+}
+
+bool intersectsAABB(vec3 rayOrigin, vec3 rayDirection, vec3 gridMin, vec3 gridMax, out float tNear) {
+    vec3 tMin = (gridMin - rayOrigin) / rayDirection;
+    vec3 tMax = (gridMax - rayOrigin) / rayDirection;
+    vec3 t1 = min(tMin, tMax);
+    vec3 t2 = max(tMin, tMax);
+    tNear = max(max(t1.x, t1.y), t1.z);
+    float tFar = min(min(t2.x, t2.y), t2.z);
+    return tNear <= tFar && tFar >= 0.0;
+}
+
+// Camera ray through a point on the screen, screenUV runs from -1 to 1 on both axes
+void camera_ray(in vec2 screenUV, out vec3 rayOrigin, out vec3 rayDirection) {
+    // Calculate camera orientation
+    vec3 forward = normalize(settings.camera_focus.xyz - settings.camera_position.xyz); // Forward direction
+    vec3 worldUp = vec3(0.0, 1.0, 0.0); // World up vector
+    vec3 right = normalize(cross(worldUp, forward)); // Right vector
+    vec3 up = cross(forward, right); // Up vector
+
+    // Adjust UV for non-square aspect ratio
+    vec2 adjustedUV = screenUV;
+    adjustedUV.x *= settings.aspect_ratio; // Scale the x-coordinate by the aspect ratio
+
+    // Ray origin and direction
+    rayOrigin = settings.camera_position.xyz;
+    rayDirection = normalize(adjustedUV.x * right + adjustedUV.y * up + forward); // Combine screen-space uv with camera orientation
+}
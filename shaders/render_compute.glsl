@@ -0,0 +1,230 @@
+#version 430
+
+// One work group per 8x8 tile of the screen
+layout(local_size_x = 8, local_size_y = 8, local_size_z = 1) in;
+
+#define USE_TRANSPARENCY
+
+#define USE_PYRAMID_SKIPPING
+
+#define USE_DEPTH_PREPASS
+
+#define USE_BAKED_DENSITY
+
+#define USE_TRAIL_SAMPLER
+
+#define USE_CHECKERBOARD
+
+#define USE_QUARTER_CHECKERBOARD
+
+#define USE_MARCH_STATISTICS
+
+#define USE_TRAIL_LOD
+
+#define SIMULATION_SETTINGS
+
+#define OCCUPANCY_DATA
+
+layout(std430, binding = 1) buffer SettingsBuffer {
+    SimulationData settings;
+};
+
+layout(binding = 0, r32f) uniform image3D voxelData;
+
+#define TRAIL_ACCESS
+
+layout(rgba32f, binding = 1) uniform readonly image3D sdfData;
+
+// Min/max trail pyramid, always built for this renderer since the tile query runs on its coarsest level
+layout(binding = 1) uniform sampler3D trailPyramid;
+
+layout(rgba8, binding = 6) uniform writeonly image2D renderTarget;
+
+// Sub-pixel offset of this frame's rays in uv units, same as renderer.glsl
+uniform vec2 pixelJitter;
+
+#ifdef USE_DEPTH_PREPASS
+// Distance along the rays of each 8x8 tile known to be empty, from depth_prepass.glsl
+layout(r32f, binding = 7) uniform readonly image2D depthPrepass;
+#endif
+
+#ifdef USE_BAKED_DENSITY
+// Smoothed trail surface from bake_density.glsl, sampled with trilinear filtering
+layout(binding = 2) uniform sampler3D bakedDensity;
+#endif
+
+#ifdef USE_MARCH_STATISTICS
+#define MARCH_STATISTICS
+#endif
+
+#ifdef USE_TRAIL_LOD
+#define TRAIL_LOD
+#endif
+
+#define RAY_MARCHING
+
+#ifdef USE_CHECKERBOARD
+#define CHECKERBOARD_PATTERN
+#endif
+
+// Start this far before the first non-empty coarse cell, the smooth blend of the cubes reaches slightly out of their cell
+const float COARSE_START_MARGIN = 1.0;
+
+const vec4 BACKGROUND_COLOR = vec4(0.0, 0.0, 0.0, 1.0);
+
+// Rays of the tile that enter the grid, and of those the ones crossing a coarse cell with trail
+shared uint tileRaysInGrid;
+shared uint tileRaysNearTrail;
+
+
+// Walks the coarsest pyramid level along the ray from tStart, returns the distance to the first cell holding trail
+// or -1 when the ray leaves the grid without crossing one
+float coarse_hit_distance(in vec3 rayOrigin, in vec3 rayDirection, in float tStart) {
+    int level = textureQueryLevels(trailPyramid) - 1;
+    float cellSize = float(2 << level);
+
+    // Only the cells covering the current grid are up to date
+    ivec3 levelSize = ivec3((settings.grid_size + int(cellSize) - 1) / int(cellSize));
+
+    // Voxel i owns [i - 0.5, i + 0.5), so cell walls sit half a voxel below their first voxel
+    vec3 entryPoint = rayOrigin + rayDirection * tStart + 0.5;
+    ivec3 cell = clamp(ivec3(floor(entryPoint / cellSize)), ivec3(0), levelSize - 1);
+
+    ivec3 cellStep = ivec3(sign(rayDirection));
+    vec3 nextWalls = (vec3(cell) + step(0.0, rayDirection)) * cellSize - 0.5;
+    vec3 tNext = (nextWalls - rayOrigin) / rayDirection;
+    vec3 tDelta = abs(cellSize / rayDirection);
+
+    float t = tStart;
+    int maxCells = levelSize.x + levelSize.y + levelSize.z;
+
+    for (int i = 0; i < maxCells; ++i) {
+        // Same threshold map_the_world uses to ignore a voxel
+        COUNT_TEXEL_FETCHES(1);
+        if (texelFetch(trailPyramid, cell, level).y > 0.01) {
+            return t;
+        }
+
+        // Step into the neighbouring cell across the nearest wall
+        if (tNext.x < tNext.y && tNext.x < tNext.z) {
+            t = tNext.x;
+            cell.x += cellStep.x;
+            tNext.x += tDelta.x;
+        } else if (tNext.y < tNext.z) {
+            t = tNext.y;
+            cell.y += cellStep.y;
+            tNext.y += tDelta.y;
+        } else {
+            t = tNext.z;
+            cell.z += cellStep.z;
+            tNext.z += tDelta.z;
+        }
+
+        if (any(lessThan(cell, ivec3(0))) || any(greaterThanEqual(cell, levelSize))) {
+            return -1.0;
+        }
+    }
+
+    return -1.0;
+}
+
+void main() {
+    ivec2 pixel = ivec2(gl_GlobalInvocationID.xy);
+    ivec2 imageSize = imageSize(renderTarget);
+    bool insideImage = all(lessThan(pixel, imageSize));
+
+    if (gl_LocalInvocationIndex == 0) {
+        tileRaysInGrid = 0u;
+        tileRaysNearTrail = 0u;
+    }
+    barrier();
+
+    // Same mapping as the full-screen quad, pixel centers between -1 and 1
+    vec2 uv = (vec2(pixel) + 0.5) / vec2(imageSize) * 2.0 - 1.0 + pixelJitter;
+
+    vec3 rayOrigin, rayDirection;
+    camera_ray(uv, rayOrigin, rayDirection);
+
+    vec3 gridMin = vec3(0.0);
+    vec3 gridMax = vec3(settings.grid_size - 1);
+    vec3 offset = vec3(0.5); // offset to account for cube thickness
+
+    float tNear = 0.0;
+    bool entersGrid = insideImage && intersectsAABB(rayOrigin, rayDirection, gridMin - offset, gridMax + offset, tNear);
+    tNear = max(tNear, 0.0);
+
+    // Every ray that reaches the grid votes, a tile with no votes is all background
+    if (entersGrid) {
+        atomicAdd(tileRaysInGrid, 1u);
+    }
+    barrier();
+
+    if (tileRaysInGrid == 0u) {
+        if (insideImage) {
+            imageStore(renderTarget, pixel, BACKGROUND_COLOR);
+            #ifdef USE_CHECKERBOARD
+            checkerboard_store_depth(pixel, rayDirection, -1.0);
+            #endif
+            #ifdef USE_MARCH_STATISTICS
+            record_march_statistics();
+            #endif
+        }
+        return;
+    }
+
+    // Coarse occupancy query, rays crossing only empty cells can never hit anything
+    float coarseHit = entersGrid ? coarse_hit_distance(rayOrigin, rayDirection, tNear) : -1.0;
+    if (coarseHit >= 0.0) {
+        atomicAdd(tileRaysNearTrail, 1u);
+    }
+    barrier();
+
+    #ifdef USE_CHECKERBOARD
+    // Left for checkerboard_resolve.glsl to fill in, after voting so the tile decisions match full resolution
+    if (!checkerboard_marches(pixel)) {
+        return;
+    }
+    #endif
+
+    // Rejects the whole tile together, or just this ray when the others still have work
+    if (tileRaysNearTrail == 0u || coarseHit < 0.0) {
+        if (insideImage) {
+            imageStore(renderTarget, pixel, BACKGROUND_COLOR);
+            #ifdef USE_CHECKERBOARD
+            checkerboard_store_depth(pixel, rayDirection, -1.0);
+            #endif
+            #ifdef USE_MARCH_STATISTICS
+            record_march_statistics();
+            #endif
+        }
+        return;
+    }
+
+    // Nothing lies between the grid entry and the first coarse cell with trail
+    float startDistance = max(coarseHit - COARSE_START_MARGIN, tNear);
+
+    #ifdef USE_DEPTH_PREPASS
+    // The work group is the prepass tile, its cone found nothing before here
+    startDistance = max(startDistance, imageLoad(depthPrepass, ivec2(gl_WorkGroupID.xy)).x);
+    #endif
+    startDistance = max(startDistance - 0.001, 0.0);
+    rayOrigin += rayDirection * startDistance;
+
+    #ifdef USE_TRANSPARENCY
+    imageStore(renderTarget, pixel, vec4(ray_march_transparency(rayOrigin, rayDirection), 1.0));
+    #else
+    imageStore(renderTarget, pixel, vec4(ray_march(rayOrigin, rayDirection), 1.0));
+    #endif
+
+    #ifdef USE_CHECKERBOARD
+    #ifdef USE_TRANSPARENCY
+    checkerboard_store_depth(pixel, rayDirection, -1.0);
+    #else
+    checkerboard_store_depth(pixel, rayDirection, rayMarchHitDistance < 0.0 ? -1.0 : startDistance + rayMarchHitDistance);
+    #endif
+    #endif
+
+    #ifdef USE_MARCH_STATISTICS
+    record_march_statistics();
+    #endif
+}
@@ -0,0 +1,57 @@
+#version 430
+
+// Simulation Settings
+#define SIMULATION_SETTINGS
+
+#define OCCUPANCY_DATA
+
+layout(local_size_x = 8, local_size_y = 8, local_size_z = 8) in;
+
+layout(std430, binding = 1) buffer SettingsBuffer {
+    SimulationData settings;
+};
+
+layout(binding = 0, r32f) uniform image3D voxelData;
+
+// Copy of the trail at the previous grid size, filtered linearly and clamped at its faces
+layout(binding = 8) uniform sampler3D previousTrail;
+
+// The work group covers whole occupancy bricks, so it owns their words and can overwrite them
+const ivec3 GROUP_BRICKS = ivec3(gl_WorkGroupSize) / OCCUPANCY_BRICK_SIZE;
+const uint GROUP_BRICK_COUNT = uint(GROUP_BRICKS.x * GROUP_BRICKS.y * GROUP_BRICKS.z);
+
+shared uint brickBits[GROUP_BRICK_COUNT];
+
+
+void main() {
+    uint localIndex = gl_LocalInvocationIndex;
+    if (localIndex < GROUP_BRICK_COUNT) {
+        brickBits[localIndex] = 0u;
+    }
+    barrier();
+
+    ivec3 location = ivec3(gl_GlobalInvocationID);
+
+    // Out of bounds invocations still have to reach the barriers below
+    if (all(lessThan(location, ivec3(settings.grid_size)))) {
+        // Voxel i is centred on i + 0.5, the centres of the new grid map onto the old one by the resize factor
+        vec3 previousPosition = (vec3(location) + 0.5) / settings.grid_resize_factor;
+        float voxelValue = texture(previousTrail, previousPosition / vec3(textureSize(previousTrail, 0))).x;
+        imageStore(voxelData, location, vec4(voxelValue));
+
+        if (voxelValue > 0.0) {
+            ivec3 localBrick = ivec3(gl_LocalInvocationID) / OCCUPANCY_BRICK_SIZE;
+            atomicOr(brickBits[localBrick.x + GROUP_BRICKS.x * (localBrick.y + GROUP_BRICKS.y * localBrick.z)], occupancy_bit(location));
+        }
+    }
+    barrier();
+
+    if (localIndex < GROUP_BRICK_COUNT) {
+        ivec3 localBrick = ivec3(localIndex % GROUP_BRICKS.x, (localIndex / GROUP_BRICKS.x) % GROUP_BRICKS.y, localIndex / (GROUP_BRICKS.x * GROUP_BRICKS.y));
+        ivec3 brick = ivec3(gl_WorkGroupID) * GROUP_BRICKS + localBrick;
+
+        if (all(lessThan(brick * OCCUPANCY_BRICK_SIZE, ivec3(settings.grid_size)))) {
+            imageStore(occupancyData, brick, uvec4(brickBits[localIndex]));
+        }
+    }
+}
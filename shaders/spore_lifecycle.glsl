@@ -0,0 +1,182 @@
+#version 430
+
+#define SPORE_STRUCT
+
+// Simulation Settings
+#define SIMULATION_SETTINGS
+
+#define RANDOM_NUMBERS
+
+#define SPORE_POPULATION
+
+layout(local_size_x = SPORE_LIFECYCLE_GROUP_SIZE, local_size_y = 1, local_size_z = 1) in;
+
+// Buffers
+layout(std430, binding = 0) readonly buffer SporesBuffer {
+    Spore spores[];
+};
+
+layout(std430, binding = 1) buffer SettingsBuffer {
+    SimulationData settings;
+};
+
+// Per spore its first slot within its work group << 2 | the spores it leaves (0 to 2). Past the capacity every work
+// group's total, replaced by its first slot overall once the totals are scanned.
+layout(std430, binding = 9) buffer SporeScanBuffer {
+    uint sporeScan[];
+};
+
+// Survivors and newborns in their old order, swapped with the spore buffer afterwards
+layout(std430, binding = 10) writeonly buffer NextSporesBuffer {
+    Spore nextSpores[];
+};
+
+layout(binding = 0, r32f) uniform image3D voxelData;
+
+// 0 decides every spore's fate, 1 scans the work group totals, 2 moves the spores, 3 commits the count
+uniform int lifecycleStage;
+// Counts the lifecycle steps, each one draws new numbers
+uniform int lifecycleStep;
+
+// Spores in voxels with at least crowdingTrail die at deathRate per second. Below it, spores in voxels with at least
+// spawnTrail split at spawnRate per second, the child starts where its parent is with a random heading.
+uniform float crowdingTrail;
+uniform float deathRate;
+uniform float spawnTrail;
+uniform float spawnRate;
+
+const int STAGE_DECIDE = 0;
+const int STAGE_SCAN_GROUPS = 1;
+const int STAGE_SCATTER = 2;
+const int STAGE_COMMIT = 3;
+
+const uint GROUP_INVOCATIONS = gl_WorkGroupSize.x;
+
+shared uint groupScan[GROUP_INVOCATIONS];
+shared uint groupBirths, groupDeaths;
+
+uint step_seed() {
+    return random_bits(uint(settings.seed), uint(lifecycleStep), 0u);
+}
+
+// Inclusive Hillis-Steele scan of groupScan, every invocation has to take part
+void scan_group(uint localIndex) {
+    barrier();
+    for (uint offset = 1u; offset < GROUP_INVOCATIONS; offset *= 2u) {
+        uint before = localIndex >= offset ? groupScan[localIndex - offset] : 0u;
+        barrier();
+        groupScan[localIndex] += before;
+        barrier();
+    }
+}
+
+void decide(uint sporeID, uint localIndex) {
+    if (localIndex == 0u) {
+        groupBirths = 0u;
+        groupDeaths = 0u;
+    }
+    barrier();
+
+    uint outputs = 0u;
+    if (sporeID < population.liveCount) {
+        int gridSize = settings.grid_size;
+        ivec3 voxelCoord = clamp(ivec3(floor(spores[sporeID].position.xyz)), ivec3(0), ivec3(gridSize - 1));
+        float trail = imageLoad(voxelData, voxelCoord).x;
+
+        uint seed = step_seed();
+        bool dies = trail >= crowdingTrail && random_unit(seed, sporeID, SPORE_DRAW_DEATH) < deathRate * settings.delta_time;
+        bool spawns = trail >= spawnTrail && trail < crowdingTrail && random_unit(seed, sporeID, SPORE_DRAW_SPAWN) < spawnRate * settings.delta_time;
+
+        // A spawning spore always survives, one output is the spore itself and two are it and its child
+        outputs = dies ? 0u : (spawns ? 2u : 1u);
+        if (dies) {
+            atomicAdd(groupDeaths, 1u);
+        }
+        if (spawns) {
+            atomicAdd(groupBirths, 1u);
+        }
+    }
+
+    groupScan[localIndex] = outputs;
+    scan_group(localIndex);
+
+    if (sporeID < population.liveCount) {
+        sporeScan[sporeID] = (groupScan[localIndex] - outputs) << 2 | outputs;
+    }
+    if (localIndex == GROUP_INVOCATIONS - 1u) {
+        sporeScan[population.capacity + gl_WorkGroupID.x] = groupScan[localIndex];
+    }
+    if (localIndex == 0u) {
+        atomicAdd(population.births, groupBirths);
+        atomicAdd(population.deaths, groupDeaths);
+    }
+}
+
+// One work group, each invocation serially sums a run of the totals, the runs are scanned in shared memory
+void scan_groups(uint localIndex) {
+    uint groupCount = (population.liveCount + GROUP_INVOCATIONS - 1u) / GROUP_INVOCATIONS;
+    uint perInvocation = (groupCount + GROUP_INVOCATIONS - 1u) / GROUP_INVOCATIONS;
+    uint first = population.capacity + min(localIndex * perInvocation, groupCount);
+    uint last = population.capacity + min((localIndex + 1u) * perInvocation, groupCount);
+
+    uint runTotal = 0u;
+    for (uint entry = first; entry < last; ++entry) {
+        runTotal += sporeScan[entry];
+    }
+
+    groupScan[localIndex] = runTotal;
+    scan_group(localIndex);
+
+    uint slot = groupScan[localIndex] - runTotal;
+    for (uint entry = first; entry < last; ++entry) {
+        uint groupTotal = sporeScan[entry];
+        sporeScan[entry] = slot;
+        slot += groupTotal;
+    }
+
+    if (localIndex == GROUP_INVOCATIONS - 1u) {
+        population.nextLiveCount = min(groupScan[localIndex], population.capacity);
+    }
+}
+
+void scatter(uint sporeID) {
+    if (sporeID >= population.liveCount) {
+        return;
+    }
+
+    uint entry = sporeScan[sporeID];
+    uint outputs = entry & 3u;
+    uint slot = sporeScan[population.capacity + gl_WorkGroupID.x] + (entry >> 2u);
+
+    Spore spore = spores[sporeID];
+    if (outputs >= 1u && slot < population.capacity) {
+        nextSpores[slot] = spore;
+    }
+    if (outputs == 2u && slot + 1u < population.capacity) {
+        spore.orientation = random_orientation(step_seed(), sporeID);
+        nextSpores[slot + 1u] = spore;
+    }
+}
+
+void commit() {
+    uint liveCount = population.nextLiveCount;
+    population.liveCount = liveCount;
+    population.sporeGroups[0] = (liveCount + SPORE_GROUP_SIZE - 1u) / SPORE_GROUP_SIZE;
+    population.lifecycleGroups[0] = (liveCount + SPORE_LIFECYCLE_GROUP_SIZE - 1u) / SPORE_LIFECYCLE_GROUP_SIZE;
+}
+
+void main() {
+    uint localIndex = gl_LocalInvocationIndex;
+    uint sporeID = gl_GlobalInvocationID.x;
+
+    // The decide and scatter stages run over the old live count, it only changes in the last stage
+    if (lifecycleStage == STAGE_DECIDE) {
+        decide(sporeID, localIndex);
+    } else if (lifecycleStage == STAGE_SCAN_GROUPS) {
+        scan_groups(localIndex);
+    } else if (lifecycleStage == STAGE_SCATTER) {
+        scatter(sporeID);
+    } else if (localIndex == 0u) {
+        commit();
+    }
+}
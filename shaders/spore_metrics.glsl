@@ -0,0 +1,86 @@
+#version 430
+
+#define WRAP_AROUND
+
+#define SPORE_STRUCT
+
+// Simulation Settings
+#define SIMULATION_SETTINGS
+
+#define TRAIL_METRICS
+
+layout(local_size_x = 64, local_size_y = 1, local_size_z = 1) in;
+
+layout(std430, binding = 0) buffer SporesBuffer {
+    Spore spores[];
+};
+
+layout(std430, binding = 1) buffer SettingsBuffer {
+    SimulationData settings;
+};
+
+// Position and heading of every spore at the previous metrics pass, its motion is measured against them
+struct SporeSnapshot {
+    vec4 position;
+    vec4 forward;
+};
+
+layout(std430, binding = 7) buffer SnapshotBuffer {
+    SporeSnapshot snapshots[];
+};
+
+// Simulated seconds since the snapshot, 0 when there is none yet to compare against
+uniform float snapshotAge;
+
+const uint GROUP_INVOCATIONS = gl_WorkGroupSize.x;
+
+shared float speedSums[GROUP_INVOCATIONS];
+shared float turnSums[GROUP_INVOCATIONS];
+
+
+void main() {
+    uint localIndex = gl_LocalInvocationIndex;
+    uint sporeID = gl_GlobalInvocationID.x;
+    bool validSpore = sporeID < uint(settings.spore_count);
+
+    float speed = 0.0, turnRate = 0.0;
+    if (validSpore) {
+        Spore spore = spores[sporeID];
+        vec3 position = spore.position.xyz;
+        vec3 forward = spore.orientation[2];
+
+        if (snapshotAge > 0.0) {
+            vec3 offset = position - snapshots[sporeID].position.xyz;
+            #ifdef WRAP_AROUND
+            // The shortest way round, spores crossing a face of the grid reappear at the opposite one
+            offset -= float(settings.grid_size) * round(offset / float(settings.grid_size));
+            #endif
+
+            // Net motion over the interval, a spore circling in place has a low speed and a high turn rate
+            speed = length(offset) / snapshotAge;
+            turnRate = acos(clamp(dot(forward, snapshots[sporeID].forward.xyz), -1.0, 1.0)) / snapshotAge;
+        }
+
+        snapshots[sporeID].position = vec4(position, 0.0);
+        snapshots[sporeID].forward = vec4(forward, 0.0);
+    }
+
+    speedSums[localIndex] = speed;
+    turnSums[localIndex] = turnRate;
+    barrier();
+
+    // Tree sum, half the invocations drop out every round
+    for (uint stride = GROUP_INVOCATIONS / 2u; stride > 0u; stride /= 2u) {
+        if (localIndex < stride) {
+            speedSums[localIndex] += speedSums[localIndex + stride];
+            turnSums[localIndex] += turnSums[localIndex + stride];
+        }
+        barrier();
+    }
+
+    if (localIndex == 0u && snapshotAge > 0.0) {
+        atomicAdd(trailMetrics.sporeCount, min(GROUP_INVOCATIONS, uint(settings.spore_count) - gl_WorkGroupID.x * GROUP_INVOCATIONS));
+        ADD_METRIC_SUM(speedSumLow, speedSumHigh, speedSums[0], SPORE_METRIC_SCALE);
+        ADD_METRIC_SUM(turnSumLow, turnSumHigh, turnSums[0], SPORE_METRIC_SCALE);
+    }
+}
@@ -0,0 +1,16 @@
+// Reads of the trail grid for shaders that never write it, injected through the TRAIL_ACCESS placeholder after
+// voxelData is declared. With USE_TRAIL_SAMPLER they go through the texture cache as a sampler3D,
+// otherwise through the voxelData image like the passes that write the grid.
+
+#if defined(USE_TRAIL_SAMPLER) || defined(USE_TRILINEAR_SENSING)
+// Same texture as voxelData, filtered linearly for texture() while texelFetch still reads single voxels
+layout(binding = 3) uniform sampler3D trailTexture;
+#endif
+
+float load_trail(in ivec3 voxel) {
+#ifdef USE_TRAIL_SAMPLER
+    return texelFetch(trailTexture, voxel, 0).x;
+#else
+    return imageLoad(voxelData, voxel).x;
+#endif
+}
@@ -0,0 +1,18 @@
+// Coarse reads of the trail grid from the mean mip chain build_trail_lod.glsl writes, injected through the
+// TRAIL_LOD placeholder. Level 1 averages 2x2x2 voxels, level 2 4x4x4 and so on, level 0 is the grid itself.
+
+// Texture level 0 holds trail level 1, its size is a power of two so every level halves exactly
+layout(binding = 7) uniform sampler3D trailLod;
+
+// Mean trail around position (voxel i spans [i, i + 1)) at a fractional level of at least 1, filtered within
+// and between the two nearest levels, levels past the coarsest one read that one
+float sample_trail_lod(in vec3 position, in float level, in int gridSize) {
+    level = min(level, float(textureQueryLevels(trailLod)));
+
+    // Half a cell inside the grid, the texels past it still hold trail from a larger grid
+    float halfCell = exp2(ceil(level)) * 0.5;
+    vec3 clampedPosition = clamp(position, vec3(halfCell), vec3(max(float(gridSize) - halfCell, halfCell)));
+
+    vec3 lodExtent = vec3(textureSize(trailLod, 0) * 2);
+    return textureLod(trailLod, clampedPosition / lodExtent, level - 1.0).x;
+}
@@ -0,0 +1,102 @@
+#version 430
+
+// Simulation Settings
+#define SIMULATION_SETTINGS
+
+#define OCCUPANCY_DATA
+
+#define TRAIL_METRICS
+
+layout(local_size_x = 8, local_size_y = 8, local_size_z = 8) in;
+
+layout(std430, binding = 1) buffer SettingsBuffer {
+    SimulationData settings;
+};
+
+layout(binding = 0, r32f) uniform image3D voxelData;
+
+// The work group covers whole occupancy bricks, it skips the grid where they are all empty
+const ivec3 GROUP_BRICKS = ivec3(gl_WorkGroupSize) / OCCUPANCY_BRICK_SIZE;
+const uint GROUP_BRICK_COUNT = uint(GROUP_BRICKS.x * GROUP_BRICKS.y * GROUP_BRICKS.z);
+const uint GROUP_INVOCATIONS = gl_WorkGroupSize.x * gl_WorkGroupSize.y * gl_WorkGroupSize.z;
+
+shared uint groupOccupied;
+shared float massSums[GROUP_INVOCATIONS];
+shared uint groupVoxels, groupMaxTrail;
+shared uint groupMin[3], groupMax[3];
+shared uint groupHistogram[TRAIL_HISTOGRAM_BINS];
+
+
+void main() {
+    uint localIndex = gl_LocalInvocationIndex;
+    ivec3 location = ivec3(gl_GlobalInvocationID);
+    int gridSize = settings.grid_size;
+
+    if (localIndex == 0u) {
+        groupOccupied = 0u;
+        groupVoxels = 0u;
+        groupMaxTrail = 0u;
+        for (int axis = 0; axis < 3; ++axis) {
+            groupMin[axis] = 0xFFFFFFFFu;
+            groupMax[axis] = 0u;
+        }
+    }
+    if (localIndex < uint(TRAIL_HISTOGRAM_BINS)) {
+        groupHistogram[localIndex] = 0u;
+    }
+    barrier();
+
+    if (localIndex < GROUP_BRICK_COUNT) {
+        ivec3 localBrick = ivec3(localIndex % GROUP_BRICKS.x, (localIndex / GROUP_BRICKS.x) % GROUP_BRICKS.y, localIndex / (GROUP_BRICKS.x * GROUP_BRICKS.y));
+        ivec3 brick = ivec3(gl_WorkGroupID) * GROUP_BRICKS + localBrick;
+
+        if (all(lessThan(brick * OCCUPANCY_BRICK_SIZE, ivec3(gridSize)))) {
+            atomicOr(groupOccupied, imageLoad(occupancyData, brick).x);
+        }
+    }
+    barrier();
+
+    // The whole group leaves together, most of a sparse grid ends here after one word per brick
+    if (groupOccupied == 0u) {
+        return;
+    }
+
+    float trail = 0.0;
+    if (all(lessThan(location, ivec3(gridSize)))) {
+        trail = imageLoad(voxelData, location).x;
+    }
+
+    massSums[localIndex] = trail;
+    if (trail > 0.0) {
+        atomicAdd(groupVoxels, 1u);
+        atomicMax(groupMaxTrail, floatBitsToUint(trail));
+        atomicAdd(groupHistogram[min(int(ceil(trail * float(TRAIL_HISTOGRAM_BINS))) - 1, TRAIL_HISTOGRAM_BINS - 1)], 1u);
+        for (int axis = 0; axis < 3; ++axis) {
+            atomicMin(groupMin[axis], uint(location[axis]));
+            atomicMax(groupMax[axis], uint(location[axis]));
+        }
+    }
+    barrier();
+
+    // Tree sum, half the invocations drop out every round
+    for (uint stride = GROUP_INVOCATIONS / 2u; stride > 0u; stride /= 2u) {
+        if (localIndex < stride) {
+            massSums[localIndex] += massSums[localIndex + stride];
+        }
+        barrier();
+    }
+
+    // One invocation per total adds the group's share
+    if (localIndex == 0u && groupVoxels > 0u) {
+        atomicAdd(trailMetrics.occupiedVoxels, groupVoxels);
+        atomicMax(trailMetrics.maxTrail, groupMaxTrail);
+        ADD_METRIC_SUM(massLow, massHigh, massSums[0], TRAIL_MASS_SCALE);
+        for (int axis = 0; axis < 3; ++axis) {
+            atomicMin(trailMetrics.boundsMin[axis], groupMin[axis]);
+            atomicMax(trailMetrics.boundsMax[axis], groupMax[axis]);
+        }
+    }
+    if (localIndex < uint(TRAIL_HISTOGRAM_BINS) && groupHistogram[localIndex] > 0u) {
+        atomicAdd(trailMetrics.histogram[localIndex], groupHistogram[localIndex]);
+    }
+}
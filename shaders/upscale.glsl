@@ -0,0 +1,55 @@
+#type vertex
+#version 430 core
+
+out vec2 uv;
+
+void main() {
+    // One triangle covering the screen, no vertex buffer needed
+    vec2 corner = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    gl_Position = vec4(corner * 2.0 - 1.0, 0.0, 1.0);
+    uv = corner;
+}
+
+#type fragment
+#version 430 core
+
+in vec2 uv;
+
+out vec4 fragmentColor;
+
+// The frame rendered below window resolution
+layout(binding = 4) uniform sampler2D lowResolutionImage;
+
+// How strongly a colour difference to the nearest texel cuts a neighbour's weight
+const float EDGE_SHARPNESS = 8.0;
+
+void main() {
+    ivec2 imageSize = textureSize(lowResolutionImage, 0);
+    vec2 texel = uv * vec2(imageSize) - 0.5;
+    ivec2 base = ivec2(floor(texel));
+    vec2 fraction = texel - vec2(base);
+
+    // The 2x2 texels a bilinear fetch would blend
+    vec3 colors[4];
+    float weights[4];
+    for (int i = 0; i < 4; ++i) {
+        ivec2 offset = ivec2(i & 1, i >> 1);
+        colors[i] = texelFetch(lowResolutionImage, clamp(base + offset, ivec2(0), imageSize - 1), 0).rgb;
+
+        vec2 axisWeights = mix(1.0 - fraction, fraction, vec2(offset));
+        weights[i] = axisWeights.x * axisWeights.y;
+    }
+
+    // The nearest texel keeps its weight, neighbours across an edge fade out, smooth areas stay bilinear
+    int nearest = int(fraction.x >= 0.5) | int(fraction.y >= 0.5) << 1;
+
+    vec3 color = vec3(0.0);
+    float totalWeight = 0.0;
+    for (int i = 0; i < 4; ++i) {
+        float similarity = 1.0 / (1.0 + EDGE_SHARPNESS * length(colors[i] - colors[nearest]));
+        color += colors[i] * weights[i] * similarity;
+        totalWeight += weights[i] * similarity;
+    }
+
+    fragmentColor = vec4(color / totalWeight, 1.0);
+}
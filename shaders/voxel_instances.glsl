@@ -0,0 +1,59 @@
+#type vertex
+#version 430 core
+
+#define VOXEL_INSTANCES
+
+// One per instance, from compact_voxels.glsl
+layout(location = 0) in uvec2 voxelInstance;
+
+// Same camera the ray marchers build in camera_ray
+uniform mat4 viewProjection;
+
+uniform vec3 cameraPosition;
+
+uniform float cameraCutoutRadius;
+
+out vec3 worldPosition;
+
+// Corners of the 36 vertices of a cube, two triangles per face, corner bits are x | y << 1 | z << 2
+const int CUBE_CORNERS[VOXEL_CUBE_VERTICES] = int[](
+    0, 2, 1,  1, 2, 3,   4, 5, 6,  5, 7, 6,
+    0, 1, 4,  1, 5, 4,   2, 6, 3,  3, 6, 7,
+    0, 4, 2,  2, 4, 6,   1, 3, 5,  3, 7, 5
+);
+
+void main() {
+    vec3 center = vec3(unpack_voxel_position(voxelInstance));
+    float voxelValue = uintBitsToFloat(voxelInstance.y);
+
+    // The ray marchers cut a sphere around the camera out of the grid, collapse cubes inside it
+    if (distance(center, cameraPosition) < cameraCutoutRadius) {
+        gl_Position = vec4(0.0);
+        return;
+    }
+
+    // Cube side grows with the trail like distance_from_cube
+    int corner = CUBE_CORNERS[gl_VertexID];
+    vec3 cornerOffset = vec3(corner & 1, (corner >> 1) & 1, corner >> 2) - 0.5;
+    worldPosition = center + cornerOffset * min(voxelValue, 1.0);
+
+    gl_Position = viewProjection * vec4(worldPosition, 1.0);
+}
+
+#type fragment
+#version 430 core
+
+#define SIMULATION_SETTINGS
+
+layout(std430, binding = 1) buffer SettingsBuffer {
+    SimulationData settings;
+};
+
+in vec3 worldPosition;
+
+out vec4 fragmentColor;
+
+void main() {
+    // Same position gradient the opaque ray marcher shades with
+    fragmentColor = vec4(worldPosition / vec3(settings.grid_size), 1.0);
+}
@@ -0,0 +1,74 @@
+#include "BufferReadback.h"
+
+BufferReadback::~BufferReadback() {
+    release();
+}
+
+void BufferReadback::release() {
+    for (int i = 0; i < BUFFER_COUNT; ++i) {
+        if (fences[i]) {
+            glDeleteSync(fences[i]);
+            fences[i] = nullptr;
+        }
+    }
+    if (stagingBuffers[0]) {
+        glDeleteBuffers(BUFFER_COUNT, stagingBuffers);
+        stagingBuffers[0] = 0;
+    }
+    pendingCopies = 0;
+}
+
+void BufferReadback::queueCopy(const GLuint sourceBuffer, const GLsizeiptr size) {
+    // Created on first use so readbacks can be members constructed before the GL context
+    if (size != stagingSize) {
+        release();
+        stagingSize = size;
+    }
+    if (!stagingBuffers[0]) {
+        glGenBuffers(BUFFER_COUNT, stagingBuffers);
+        for (const GLuint buffer : stagingBuffers) {
+            glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+            glBufferData(GL_COPY_WRITE_BUFFER, size, nullptr, GL_STREAM_READ);
+        }
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+
+    // Dropping a sample is cheaper than waiting for the GPU
+    if (pendingCopies == BUFFER_COUNT) {
+        return;
+    }
+
+    glBindBuffer(GL_COPY_READ_BUFFER, sourceBuffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, stagingBuffers[nextBuffer]);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, size);
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    fences[nextBuffer] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    nextBuffer = (nextBuffer + 1) % BUFFER_COUNT;
+    pendingCopies++;
+}
+
+bool BufferReadback::readLatest(void* destination) {
+    bool read = false;
+
+    while (pendingCopies > 0) {
+        const int oldest = (nextBuffer - pendingCopies + BUFFER_COUNT) % BUFFER_COUNT;
+
+        const GLenum status = glClientWaitSync(fences[oldest], 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+            break; // Oldest one is not done yet, neither are the newer ones
+        }
+
+        glBindBuffer(GL_COPY_READ_BUFFER, stagingBuffers[oldest]);
+        glGetBufferSubData(GL_COPY_READ_BUFFER, 0, stagingSize, destination);
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+
+        glDeleteSync(fences[oldest]);
+        fences[oldest] = nullptr;
+        pendingCopies--;
+        read = true;
+    }
+
+    return read;
+}
@@ -0,0 +1,214 @@
+#include "DistanceTransform.h"
+#include "OccupancyData.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+    // Lines gathered side by side per block, adjacent lines are adjacent in memory for the y and z passes
+    constexpr int LANES = 8;
+    constexpr float INF = std::numeric_limits<float>::infinity();
+
+    // 1D squared distance transform of one line: lower envelope of the parabolas rooted at every finite sample.
+    // v and z are scratch of n and n + 1 entries.
+    void transformLine(const float* f, const int* featureIn, const int n, float* d, int* featureOut, int* v, float* z) {
+        int k = -1;
+        for (int q = 0; q < n; ++q) {
+            if (f[q] == INF) {
+                continue;
+            }
+
+            const float fq = f[q] + static_cast<float>(q * q);
+            if (k < 0) {
+                k = 0;
+                v[0] = q;
+                z[0] = -INF;
+                z[1] = INF;
+                continue;
+            }
+
+            float s;
+            while (true) {
+                const int p = v[k];
+                s = (fq - (f[p] + static_cast<float>(p * p))) / static_cast<float>(2 * (q - p));
+                if (s > z[k]) {
+                    break;
+                }
+                --k; // z[0] is -INF, so this never drops below 0
+            }
+
+            ++k;
+            v[k] = q;
+            z[k] = s;
+            z[k + 1] = INF;
+        }
+
+        if (k < 0) {
+            std::fill(d, d + n, INF);
+            std::fill(featureOut, featureOut + n, -1);
+            return;
+        }
+
+        k = 0;
+        for (int q = 0; q < n; ++q) {
+            while (z[k + 1] < static_cast<float>(q)) {
+                ++k;
+            }
+            const int p = v[k];
+            d[q] = static_cast<float>((q - p) * (q - p)) + f[p];
+            featureOut[q] = featureIn[p];
+        }
+    }
+}
+
+DistanceTransform::DistanceTransform(ThreadPool& threadPool) : pool(threadPool) {}
+
+void DistanceTransform::seedsFromOccupancy(const std::vector<uint32_t>& occupancyWords, const int brickCountX, const int brickCountY,
+                                           const int gridSize, const int reduction, std::vector<uint8_t>& seeds) const {
+    const int reducedSize = gridSize / reduction;
+    const int brickCountZ = static_cast<int>(occupancyWords.size()) / (brickCountX * brickCountY);
+    const int bricksX = std::min(brickCountX, (reducedSize * reduction + OCCUPANCY_BRICK_X - 1) / OCCUPANCY_BRICK_X);
+    const int bricksY = std::min(brickCountY, (reducedSize * reduction + OCCUPANCY_BRICK_Y - 1) / OCCUPANCY_BRICK_Y);
+
+    seeds.assign(static_cast<size_t>(reducedSize) * reducedSize * reducedSize, 0);
+
+    // One task per reduced z slice, it only writes its own seed flags
+    pool.parallelFor(0, reducedSize, [&](const int cz) {
+        const int zStart = cz * reduction;
+        const int zEnd = zStart + reduction - 1;
+
+        for (int bz = zStart / OCCUPANCY_BRICK_Z; bz <= std::min(zEnd / OCCUPANCY_BRICK_Z, brickCountZ - 1); ++bz) {
+            for (int by = 0; by < bricksY; ++by) {
+                for (int bx = 0; bx < bricksX; ++bx) {
+                    const uint32_t word = occupancyWords[bx + brickCountX * (by + static_cast<size_t>(brickCountY) * bz)];
+                    if (word == 0) {
+                        continue;
+                    }
+
+                    for (int bit = 0; bit < 32; ++bit) {
+                        if ((word >> bit & 1u) == 0) {
+                            continue;
+                        }
+
+                        const int x = bx * OCCUPANCY_BRICK_X + bit % OCCUPANCY_BRICK_X;
+                        const int y = by * OCCUPANCY_BRICK_Y + bit / OCCUPANCY_BRICK_X % OCCUPANCY_BRICK_Y;
+                        const int z = bz * OCCUPANCY_BRICK_Z + bit / (OCCUPANCY_BRICK_X * OCCUPANCY_BRICK_Y);
+
+                        const int cx = x / reduction, cy = y / reduction;
+                        if (z >= zStart && z <= zEnd && cx < reducedSize && cy < reducedSize) {
+                            seeds[cx + reducedSize * (cy + static_cast<size_t>(reducedSize) * cz)] = 1;
+                        }
+                    }
+                }
+            }
+        }
+    });
+}
+
+void DistanceTransform::compute(const std::vector<uint8_t>& seeds, const int reducedSize, const int reduction, std::vector<float>& sdfTexels) {
+    const int size = reducedSize;
+    const size_t cellCount = static_cast<size_t>(size) * size * size;
+
+    squaredDistances.resize(cellCount);
+    features.resize(cellCount);
+    for (size_t i = 0; i < cellCount; ++i) {
+        squaredDistances[i] = seeds[i] ? 0.0f : INF;
+        features[i] = static_cast<int>(i);
+    }
+
+    // x lines lie along memory, y and z lines are gathered LANES at a time from contiguous rows
+    transformAxis(size, 1, size, size * size);
+    transformAxis(size, size, 1, size * size);
+    transformAxis(size, size * size, 1, size);
+
+    sdfTexels.resize(cellCount * 4);
+    pool.parallelFor(0, size, [&](const int z) {
+        for (int y = 0; y < size; ++y) {
+            for (int x = 0; x < size; ++x) {
+                const size_t i = x + size * (y + static_cast<size_t>(size) * z);
+                float* texel = &sdfTexels[i * 4];
+                const int feature = features[i];
+
+                if (feature < 0) {
+                    texel[0] = static_cast<float>(x * reduction);
+                    texel[1] = static_cast<float>(y * reduction);
+                    texel[2] = static_cast<float>(z * reduction);
+                    texel[3] = SDF_EMPTY_DISTANCE;
+                    continue;
+                }
+
+                texel[0] = static_cast<float>(feature % size * reduction);
+                texel[1] = static_cast<float>(feature / size % size * reduction);
+                texel[2] = static_cast<float>(feature / (size * size) * reduction);
+                texel[3] = std::sqrt(squaredDistances[i]) * static_cast<float>(reduction);
+            }
+        }
+    });
+}
+
+void DistanceTransform::transformAxis(const int reducedSize, const int stride, const int lineStride, const int sliceStride) {
+    const int n = reducedSize;
+
+    // Every slice holds n lines along the axis, slices are independent
+    pool.parallelFor(0, n, [&](const int slice) {
+        std::vector<float> lineIn(static_cast<size_t>(LANES) * n), lineOut(static_cast<size_t>(LANES) * n);
+        std::vector<int> featureIn(static_cast<size_t>(LANES) * n), featureOut(static_cast<size_t>(LANES) * n);
+        std::vector<int> v(n);
+        std::vector<float> z(n + 1);
+
+        const size_t sliceBase = static_cast<size_t>(slice) * sliceStride;
+
+        for (int firstLine = 0; firstLine < n; firstLine += LANES) {
+            const int lanes = std::min(LANES, n - firstLine);
+
+            // Gather, lane-major so each line is contiguous for the envelope pass
+            for (int q = 0; q < n; ++q) {
+                const size_t rowBase = sliceBase + static_cast<size_t>(firstLine) * lineStride + static_cast<size_t>(q) * stride;
+                for (int lane = 0; lane < lanes; ++lane) {
+                    lineIn[lane * n + q] = squaredDistances[rowBase + static_cast<size_t>(lane) * lineStride];
+                    featureIn[lane * n + q] = features[rowBase + static_cast<size_t>(lane) * lineStride];
+                }
+            }
+
+            for (int lane = 0; lane < lanes; ++lane) {
+                transformLine(&lineIn[lane * n], &featureIn[lane * n], n, &lineOut[lane * n], &featureOut[lane * n], v.data(), z.data());
+            }
+
+            for (int q = 0; q < n; ++q) {
+                const size_t rowBase = sliceBase + static_cast<size_t>(firstLine) * lineStride + static_cast<size_t>(q) * stride;
+                for (int lane = 0; lane < lanes; ++lane) {
+                    squaredDistances[rowBase + static_cast<size_t>(lane) * lineStride] = lineOut[lane * n + q];
+                    features[rowBase + static_cast<size_t>(lane) * lineStride] = featureOut[lane * n + q];
+                }
+            }
+        }
+    });
+}
+
+DistanceFieldError DistanceTransform::compare(const std::vector<float>& referenceTexels, const std::vector<float>& candidateTexels) {
+    DistanceFieldError error;
+    double errorSum = 0.0;
+    size_t comparedCells = 0;
+
+    const size_t cellCount = std::min(referenceTexels.size(), candidateTexels.size()) / 4;
+    for (size_t i = 0; i < cellCount; ++i) {
+        const float reference = referenceTexels[i * 4 + 3];
+        const float candidate = candidateTexels[i * 4 + 3];
+
+        const bool referenceEmpty = reference >= SDF_EMPTY_DISTANCE;
+        const bool candidateEmpty = candidate >= SDF_EMPTY_DISTANCE;
+        if (referenceEmpty || candidateEmpty) {
+            error.missingSeeds += referenceEmpty != candidateEmpty;
+            continue;
+        }
+
+        const float difference = std::abs(candidate - reference);
+        error.maxError = std::max(error.maxError, difference);
+        errorSum += difference;
+        ++comparedCells;
+    }
+
+    error.meanError = comparedCells > 0 ? static_cast<float>(errorSum / static_cast<double>(comparedCells)) : 0.0f;
+    return error;
+}
@@ -0,0 +1,200 @@
+#include "Ensemble.h"
+
+#include <algorithm>
+#include "OccupancyData.h"
+
+// Same bindings as the single simulation, the shaders only differ in how they find their member
+constexpr int SPORE_BUFFER_LOCATION = 0;
+constexpr int SIMULATION_BUFFER_LOCATION = 1;
+constexpr int GRID_TEXTURE_LOCATION = 0;
+constexpr int OCCUPANCY_TEXTURE_LOCATION = 3;
+constexpr int TRAIL_TEXTURE_UNIT = 3;
+
+constexpr int SPORE_WORK_GROUP_SIZE = 8;
+// Grid passes run 8x8x8 groups over the whole atlas, whole groups per tile keep each group inside one member
+constexpr int GRID_WORK_GROUP_SIZE = 8;
+
+namespace {
+    int memberGridSizeFor(const int gridSize) {
+        return (std::max(gridSize, 1) + GRID_WORK_GROUP_SIZE - 1) / GRID_WORK_GROUP_SIZE * GRID_WORK_GROUP_SIZE;
+    }
+
+    // Smallest square holding every member, same count as ensemble_tiles_per_row() in ensemble.glsl
+    int tileColumnsFor(const int memberCount) {
+        int columns = 1;
+        while (columns * columns < memberCount) {
+            ++columns;
+        }
+        return columns;
+    }
+}
+
+Ensemble::~Ensemble() {
+    release();
+}
+
+void Ensemble::setPrograms(const EnsemblePrograms& ensemblePrograms) {
+    programs = ensemblePrograms;
+}
+
+void Ensemble::release() {
+    if (sporesBuffer)
+        glDeleteBuffers(1, &sporesBuffer);
+    if (settingsBuffer)
+        glDeleteBuffers(1, &settingsBuffer);
+    if (atlasTexture)
+        glDeleteTextures(1, &atlasTexture);
+    if (occupancyTexture)
+        glDeleteTextures(1, &occupancyTexture);
+    sporesBuffer = settingsBuffer = atlasTexture = occupancyTexture = 0;
+}
+
+int Ensemble::atlasSizeFor(const int gridSize, const int memberCount) {
+    return tileColumnsFor(memberCount) * memberGridSizeFor(gridSize);
+}
+
+void Ensemble::configure(const std::vector<SimulationData>& memberSettings) {
+    release();
+    members = memberSettings;
+    if (members.empty()) {
+        return;
+    }
+
+    memberGridSize = memberGridSizeFor(members[0].grid_size);
+    sporesPerMember = std::max(members[0].spore_count, 1);
+    for (SimulationData& settings : members) {
+        settings.grid_size = memberGridSize;
+        settings.spore_count = sporesPerMember;
+    }
+
+    tileColumns = tileColumnsFor(memberCount());
+    tileRows = (memberCount() + tileColumns - 1) / tileColumns;
+
+    glGenBuffers(1, &sporesBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, sporesBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, static_cast<GLsizeiptr>(sizeof(Spore)) * sporesPerMember * memberCount(), nullptr, GL_DYNAMIC_DRAW);
+
+    // Sized to the members exactly, the shaders count them with length()
+    glGenBuffers(1, &settingsBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, settingsBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, static_cast<GLsizeiptr>(sizeof(SimulationData)) * memberCount(), members.data(), GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    const int atlasWidth = tileColumns * memberGridSize;
+    const int atlasHeight = tileRows * memberGridSize;
+
+    glGenTextures(1, &atlasTexture);
+    glBindTexture(GL_TEXTURE_3D, atlasTexture);
+    glTexStorage3D(GL_TEXTURE_3D, 1, GL_R32F, atlasWidth, atlasHeight, memberGridSize);
+    // Linear only affects trilinear sensing, which stays half a voxel inside the member's tile
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+
+    // Decay, draw and clear keep the occupancy bricks of the atlas like they do for the single grid
+    glGenTextures(1, &occupancyTexture);
+    glBindTexture(GL_TEXTURE_3D, occupancyTexture);
+    glTexStorage3D(GL_TEXTURE_3D, 1, GL_R32UI, (atlasWidth + OCCUPANCY_BRICK_X - 1) / OCCUPANCY_BRICK_X,
+                   (atlasHeight + OCCUPANCY_BRICK_Y - 1) / OCCUPANCY_BRICK_Y, (memberGridSize + OCCUPANCY_BRICK_Z - 1) / OCCUPANCY_BRICK_Z);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_3D, 0);
+
+    reset();
+}
+
+void Ensemble::bind() const {
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, SPORE_BUFFER_LOCATION, sporesBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, SIMULATION_BUFFER_LOCATION, settingsBuffer);
+    glBindImageTexture(GRID_TEXTURE_LOCATION, atlasTexture, 0, GL_TRUE, 0, GL_READ_WRITE, GL_R32F);
+    glBindImageTexture(OCCUPANCY_TEXTURE_LOCATION, occupancyTexture, 0, GL_TRUE, 0, GL_READ_WRITE, GL_R32UI);
+
+    glActiveTexture(GL_TEXTURE0 + TRAIL_TEXTURE_UNIT);
+    glBindTexture(GL_TEXTURE_3D, atlasTexture);
+    glActiveTexture(GL_TEXTURE0);
+}
+
+void Ensemble::readAtlas(std::vector<float>& values) const {
+    values.resize(static_cast<size_t>(atlasSize()) * tileRows * memberGridSize * memberGridSize);
+    // The passes wrote it as an image
+    glMemoryBarrier(GL_TEXTURE_UPDATE_BARRIER_BIT);
+    glBindTexture(GL_TEXTURE_3D, atlasTexture);
+    glGetTexImage(GL_TEXTURE_3D, 0, GL_RED, GL_FLOAT, values.data());
+    glBindTexture(GL_TEXTURE_3D, 0);
+}
+
+void Ensemble::readSpores(const int member, std::vector<Spore>& spores) const {
+    spores.resize(sporesPerMember);
+    // The passes wrote them as storage
+    glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, sporesBuffer);
+    glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, static_cast<GLintptr>(sizeof(Spore)) * sporesPerMember * member,
+                       static_cast<GLsizeiptr>(sizeof(Spore)) * sporesPerMember, spores.data());
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+void Ensemble::uploadSettings() const {
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, settingsBuffer);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, static_cast<GLsizeiptr>(sizeof(SimulationData)) * memberCount(), members.data());
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+void Ensemble::setMember(const int member, const SimulationData& settings) {
+    members[member] = settings;
+    members[member].grid_size = memberGridSize;
+    members[member].spore_count = sporesPerMember;
+}
+
+void Ensemble::reset() {
+    if (members.empty()) {
+        return;
+    }
+
+    uploadSettings();
+    bind();
+
+    const GLuint sporeGroups = (sporesPerMember + SPORE_WORK_GROUP_SIZE - 1) / SPORE_WORK_GROUP_SIZE;
+    const GLuint gridGroups = memberGridSize / GRID_WORK_GROUP_SIZE;
+
+    glUseProgram(programs.clearGrid);
+    glDispatchCompute(gridGroups * tileColumns, gridGroups * tileRows, gridGroups);
+
+    // Spore passes run one row of work groups per member
+    glUseProgram(programs.randomizeSpores);
+    glDispatchCompute(sporeGroups, memberCount(), 1);
+
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
+    ++trailGeneration;
+}
+
+void Ensemble::step(const float deltaTime) {
+    if (members.empty()) {
+        return;
+    }
+
+    for (SimulationData& settings : members) {
+        settings.delta_time = deltaTime;
+    }
+    uploadSettings();
+    bind();
+
+    const GLuint sporeGroups = (sporesPerMember + SPORE_WORK_GROUP_SIZE - 1) / SPORE_WORK_GROUP_SIZE;
+    const GLuint gridGroups = memberGridSize / GRID_WORK_GROUP_SIZE;
+
+    glUseProgram(programs.decaySpores);
+    glDispatchCompute(gridGroups * tileColumns, gridGroups * tileRows, gridGroups);
+    glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
+
+    glUseProgram(programs.moveSpores);
+    glDispatchCompute(sporeGroups, memberCount(), 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    glUseProgram(programs.drawSpores);
+    glDispatchCompute(sporeGroups, memberCount(), 1);
+
+    // The projection reads the atlas as an image, the next step's sensing maybe through the sampler
+    glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
+    ++trailGeneration;
+}
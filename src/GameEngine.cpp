@@ -7,8 +7,8 @@
 #include <sstream>
 #include <utility>
 
-GameEngine::GameEngine(const int width, const int height, std::string  title, const bool vSync)
-    : window(nullptr), width(width), height(height), title(std::move(title)), lastFrameTime(0.0f), deltaTime(0.0f), timeSinceStart(0.0f), vSyncEnabled(vSync) {
+GameEngine::GameEngine(const int width, const int height, std::string  title, const bool vSync, const bool headless)
+    : window(nullptr), width(width), height(height), title(std::move(title)), lastFrameTime(0.0f), deltaTime(0.0f), timeSinceStart(0.0f), vSyncEnabled(vSync), headless(headless) {
 
     init();
 }
@@ -250,6 +250,14 @@ void GameEngine::removeShaderDefinition(const std::string &placeholder) {
     }
 }
 
+void GameEngine::setShaderVariant(const std::string &placeholder, const bool enabled) {
+    if (enabled) {
+        shaderDefinitions.erase(placeholder);
+    } else {
+        shaderDefinitions[placeholder] = "";
+    }
+}
+
 GLuint GameEngine::CompileAndAttachShader(const std::string& source, const GLenum shaderType, const GLuint program) {
     const GLuint shader = CompileShader(source, shaderType);
     glAttachShader(program, shader);
@@ -321,6 +329,7 @@ void GameEngine::initGLFW() {
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, headless ? GLFW_FALSE : GLFW_TRUE);
 
     window = glfwCreateWindow(width, height, title.c_str(), nullptr, nullptr);
     if (!window) {
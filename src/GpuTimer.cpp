@@ -0,0 +1,61 @@
+#include "GpuTimer.h"
+
+GpuTimer::~GpuTimer() {
+    if (queries[0])
+        glDeleteQueries(QUERY_COUNT, queries);
+}
+
+void GpuTimer::begin() {
+    // Created on first use so timers can be members constructed before the GL context
+    if (!queries[0]) {
+        glGenQueries(QUERY_COUNT, queries);
+    }
+
+    // Every query is still in flight, the oldest has to be read before it can be reused
+    if (pendingQueries == QUERY_COUNT) {
+        readOldest(true);
+    }
+
+    glBeginQuery(GL_TIME_ELAPSED, queries[nextQuery]);
+}
+
+void GpuTimer::end() {
+    glEndQuery(GL_TIME_ELAPSED);
+    nextQuery = (nextQuery + 1) % QUERY_COUNT;
+    pendingQueries++;
+}
+
+float GpuTimer::latestMilliseconds() {
+    while (pendingQueries > 0) {
+        const int previousPending = pendingQueries;
+        readOldest(false);
+        if (pendingQueries == previousPending) {
+            break; // Oldest one is not done yet, neither are the newer ones
+        }
+    }
+    return latest;
+}
+
+float GpuTimer::waitMilliseconds() {
+    while (pendingQueries > 0) {
+        readOldest(true);
+    }
+    return latest;
+}
+
+void GpuTimer::readOldest(const bool wait) {
+    const GLuint query = queries[(nextQuery - pendingQueries + QUERY_COUNT) % QUERY_COUNT];
+
+    if (!wait) {
+        GLint available = GL_FALSE;
+        glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) {
+            return;
+        }
+    }
+
+    GLuint64 elapsedNanoseconds = 0;
+    glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsedNanoseconds);
+    latest = static_cast<float>(static_cast<double>(elapsedNanoseconds) / 1.0e6);
+    pendingQueries--;
+}
@@ -0,0 +1,18 @@
+#include "ImageIO.h"
+
+#include <fstream>
+
+bool ImageIO::savePPM(const std::string& path, const int width, const int height, const std::vector<uint8_t>& rgba) {
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+
+    file << "P6\n" << width << " " << height << "\n255\n";
+    for (int y = height - 1; y >= 0; --y) {
+        for (int x = 0; x < width; ++x) {
+            file.write(reinterpret_cast<const char*>(&rgba[(static_cast<size_t>(y) * width + x) * 4]), 3);
+        }
+    }
+    return static_cast<bool>(file);
+}
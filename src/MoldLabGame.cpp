@@ -1,22 +1,176 @@
+#include <algorithm>
+#include <cfloat>
+#include <cstring>
+#include <fstream>
 #include <iostream>
 #include <linmath.h>
 #include <cmath>
 #include "MoldLabGame.h"
+#include "ImageIO.h"
 #include "MeshData.h"
+#include "OccupancyData.h"
+#include "VoxelInstances.h"
 #include "imgui.h"
 
 const std::string USE_TRANSPARENCY_DEFINITION = "#define USE_TRANSPARENCY";
 const std::string SIMULATION_SETTINGS_DEFINITION = "#define SIMULATION_SETTINGS";
 const std::string SPORE_DEFINITION = "#define SPORE_STRUCT";
 const std::string WRAP_GRID_DEFINITION = "#define WRAP_AROUND";
+const std::string OCCUPANCY_DEFINITION = "#define OCCUPANCY_DATA";
+const std::string PYRAMID_SKIPPING_DEFINITION = "#define USE_PYRAMID_SKIPPING";
+const std::string RAY_MARCHING_DEFINITION = "#define RAY_MARCHING";
+const std::string DEPTH_PREPASS_DEFINITION = "#define USE_DEPTH_PREPASS";
+const std::string BAKED_DENSITY_DEFINITION = "#define USE_BAKED_DENSITY";
+const std::string TRAIL_ACCESS_DEFINITION = "#define TRAIL_ACCESS";
+const std::string TRAIL_SAMPLER_DEFINITION = "#define USE_TRAIL_SAMPLER";
+const std::string TRILINEAR_SENSING_DEFINITION = "#define USE_TRILINEAR_SENSING";
+const std::string VOXEL_INSTANCES_DEFINITION = "#define VOXEL_INSTANCES";
+const std::string CHECKERBOARD_DEFINITION = "#define USE_CHECKERBOARD";
+const std::string QUARTER_CHECKERBOARD_DEFINITION = "#define USE_QUARTER_CHECKERBOARD";
+const std::string CHECKERBOARD_PATTERN_DEFINITION = "#define CHECKERBOARD_PATTERN";
+const std::string MARCH_STATISTICS_DEFINITION = "#define MARCH_STATISTICS";
+const std::string USE_MARCH_STATISTICS_DEFINITION = "#define USE_MARCH_STATISTICS";
+const std::string TRAIL_LOD_DEFINITION = "#define TRAIL_LOD";
+const std::string USE_TRAIL_LOD_DEFINITION = "#define USE_TRAIL_LOD";
+const std::string LOD_SENSING_DEFINITION = "#define USE_LOD_SENSING";
+const std::string DEPOSIT_STATISTICS_DEFINITION = "#define DEPOSIT_STATISTICS";
+const std::string DIFFUSION_DEFINITION = "#define USE_DIFFUSION";
+const std::string ENSEMBLE_DEFINITION = "#define USE_ENSEMBLE";
+const std::string ENSEMBLE_MEMBERS_DEFINITION = "#define ENSEMBLE_MEMBERS";
+const std::string TRAIL_METRICS_DEFINITION = "#define TRAIL_METRICS";
+const std::string RANDOM_NUMBERS_DEFINITION = "#define RANDOM_NUMBERS";
+const std::string TRAIL_DIFFUSION_DEFINITION = "#define TRAIL_DIFFUSION";
+const std::string SPORE_POPULATION_DEFINITION = "#define SPORE_POPULATION";
+const std::string SPORE_LIFECYCLE_DEFINITION = "#define USE_SPORE_LIFECYCLE";
 
 
 constexpr int GRID_TEXTURE_LOCATION = 0;
 constexpr int SDF_TEXTURE_READ_LOCATION = 1;
 constexpr int SDF_TEXTURE_WRITE_LOCATION = 2;
+constexpr int OCCUPANCY_TEXTURE_LOCATION = 3;
+constexpr int TRAIL_PYRAMID_READ_LOCATION = 4;
+constexpr int TRAIL_PYRAMID_WRITE_LOCATION = 5;
+constexpr int RENDER_TARGET_LOCATION = 6;
+constexpr int DEPTH_PREPASS_LOCATION = 7;
+// Only eight image units are guaranteed, the bake borrows the pyramid's write unit which is rebound per level anyway
+constexpr int BAKED_DENSITY_WRITE_LOCATION = TRAIL_PYRAMID_WRITE_LOCATION;
+// Likewise the checkerboard depth takes the SDF's write unit, the jump flood is done with it before rendering
+constexpr int CHECKERBOARD_DEPTH_LOCATION = SDF_TEXTURE_WRITE_LOCATION;
+// The mean chain is built level by level through the pyramid's units too, both builds rebind them before use
+constexpr int TRAIL_LOD_READ_LOCATION = TRAIL_PYRAMID_READ_LOCATION;
+constexpr int TRAIL_LOD_WRITE_LOCATION = TRAIL_PYRAMID_WRITE_LOCATION;
+// The binned deposit sees the trail grid as R32UI for its compare and swaps, through the same borrowed unit
+constexpr int DEPOSIT_TRAIL_LOCATION = TRAIL_PYRAMID_WRITE_LOCATION;
+
+// Screen pixels per side of a depth prepass texel, matches the compute renderer's tiles
+constexpr int DEPTH_PREPASS_TILE_SIZE = 8;
+
+// Texture units for sampler reads, unit 0 is left to ImGui
+constexpr int TRAIL_PYRAMID_TEXTURE_UNIT = 1;
+constexpr int BAKED_DENSITY_TEXTURE_UNIT = 2;
+constexpr int TRAIL_TEXTURE_UNIT = 3;
+constexpr int RENDER_TARGET_TEXTURE_UNIT = 4;
+constexpr int CHECKERBOARD_HISTORY_TEXTURE_UNIT = 5;
+constexpr int PROJECTION_TEXTURE_UNIT = 6;
+constexpr int TRAIL_LOD_TEXTURE_UNIT = 7;
+constexpr int PREVIOUS_TRAIL_TEXTURE_UNIT = 8;
+
+// Largest side of a saved projection thumbnail
+constexpr int PROJECTION_THUMBNAIL_SIZE = 256;
+
+// Render scale range, and how the automatic scale chases its target render time
+constexpr float MIN_RENDER_SCALE = 0.25f;
+constexpr float MAX_RENDER_SCALE = 1.0f;
+constexpr float RENDER_SCALE_GAIN = 0.25f;     // Fraction of the correction applied per frame, the timer lags a few frames
+constexpr float RENDER_SCALE_TOLERANCE = 0.05f; // Render times this close to the target leave the scale alone
+
+// Progressive refinement stops adding jittered samples after this many, idle frames then cost nothing
+constexpr int MAX_ACCUMULATED_SAMPLES = 64;
+
+// Level 0 covers 2x2x2 voxels, the top level 32x32x32
+constexpr int TRAIL_PYRAMID_LEVELS = 5;
+
+// diffuse_trail.glsl holds every line of its work group in shared memory, GL 4.3 only guarantees 32 KiB of it
+static_assert(DIFFUSION_MAX_LINE_LENGTH >= SimulationDefaults::MAX_GRID_SIZE, "Diffusion lines are shorter than the largest grid");
+static_assert(DIFFUSION_LINES_PER_GROUP * DIFFUSION_MAX_LINE_LENGTH * sizeof(float) <= 32768, "Diffusion lines exceed the shared memory GL 4.3 guarantees");
+
+// Mean trail chain for distant rendering and far sensing, level 0 averages 2x2x2 voxels, the top level 32x32x32
+constexpr int TRAIL_LOD_LEVELS = 5;
+
+constexpr int OCCUPANCY_BRICKS_X = (static_cast<int>(SimulationDefaults::MAX_GRID_SIZE) + OCCUPANCY_BRICK_X - 1) / OCCUPANCY_BRICK_X;
+constexpr int OCCUPANCY_BRICKS_Y = (static_cast<int>(SimulationDefaults::MAX_GRID_SIZE) + OCCUPANCY_BRICK_Y - 1) / OCCUPANCY_BRICK_Y;
+constexpr int OCCUPANCY_BRICKS_Z = (static_cast<int>(SimulationDefaults::MAX_GRID_SIZE) + OCCUPANCY_BRICK_Z - 1) / OCCUPANCY_BRICK_Z;
 
 constexpr int SPORE_BUFFER_LOCATION = 0;
 constexpr int SIMULATION_BUFFER_LOCATION = 1;
+constexpr int VOXEL_DRAW_BUFFER_LOCATION = 2;
+constexpr int VOXEL_INSTANCE_BUFFER_LOCATION = 3;
+constexpr int MARCH_STATISTICS_BUFFER_LOCATION = 4;
+constexpr int DEPOSIT_STATISTICS_BUFFER_LOCATION = 5;
+constexpr int TRAIL_METRICS_BUFFER_LOCATION = 6;
+constexpr int SPORE_SNAPSHOT_BUFFER_LOCATION = 7;
+constexpr int SPORE_POPULATION_BUFFER_LOCATION = 8;
+constexpr int SPORE_SCAN_BUFFER_LOCATION = 9;
+constexpr int NEXT_SPORES_BUFFER_LOCATION = 10;
+constexpr int LIFECYCLE_BUFFER_BINDINGS = NEXT_SPORES_BUFFER_LOCATION + 1;
+
+// A position and a forward vector per spore, vec4s in spore_metrics.glsl
+constexpr GLsizeiptr SPORE_SNAPSHOT_SIZE = 8 * sizeof(float);
+
+// Indirect dispatches of the spore passes in the population buffer, by the passes' work group size
+constexpr GLintptr SPORE_GROUPS_OFFSET = offsetof(SporePopulation, sporeGroups);
+constexpr GLintptr LIFECYCLE_GROUPS_OFFSET = offsetof(SporePopulation, lifecycleGroups);
+
+// Decide, scan the work group totals, scatter and commit, see spore_lifecycle.glsl
+constexpr int LIFECYCLE_STAGES = 4;
+
+// Longest metrics time series kept, older samples are dropped first
+constexpr size_t MAX_METRICS_SAMPLES = 4096;
+
+// Settings the ensemble can sweep across its members
+constexpr float SimulationData::* ENSEMBLE_SWEPT_PARAMETERS[] = {
+    &SimulationData::sensor_distance, &SimulationData::sensor_angle, &SimulationData::turn_speed,
+    &SimulationData::spore_speed, &SimulationData::decay_speed,
+};
+const char* ENSEMBLE_SWEPT_PARAMETER_NAMES[] = {"Sensor Distance", "Sensor Angle", "Turn Speed", "Spore Speed", "Decay Speed"};
+constexpr int MAX_ENSEMBLE_MEMBERS = 64;
+
+// Same layout as the DrawArraysIndirectCommand block in compact_voxels.glsl
+struct VoxelDrawCommand {
+    GLuint vertexCount;
+    GLuint instanceCount;
+    GLuint firstVertex;
+    GLuint baseInstance;
+};
+
+// Radical inverse of index in the given base, low-discrepancy sub-pixel offsets for progressive refinement
+float haltonSequence(int index, const int base) {
+    float result = 0.0f;
+    float fraction = 1.0f / static_cast<float>(base);
+    while (index > 0) {
+        result += fraction * static_cast<float>(index % base);
+        index /= base;
+        fraction /= static_cast<float>(base);
+    }
+    return result;
+}
+
+// Upper edge of the histogram bin holding the given fraction of the samples
+uint32_t histogramPercentile(const uint32_t* histogram, const uint32_t binWidth, const uint32_t sampleCount, const float fraction) {
+    const auto threshold = static_cast<uint64_t>(std::ceil(static_cast<double>(sampleCount) * fraction));
+    uint64_t samplesBelow = 0;
+    for (uint32_t bin = 0; bin < MARCH_HISTOGRAM_BINS; ++bin) {
+        samplesBelow += histogram[bin];
+        if (samplesBelow >= threshold) {
+            return (bin + 1) * binWidth;
+        }
+    }
+    return MARCH_HISTOGRAM_BINS * binWidth;
+}
+
+uint64_t joinWords(const uint32_t low, const uint32_t high) {
+    return static_cast<uint64_t>(high) << 32 | low;
+}
 
 // ============================
 // Constructor/Destructor
@@ -30,6 +184,9 @@ void assignDefaultsToSimulationData(SimulationData& data, float aspectRatio) {
     data.turn_speed = SimulationDefaults::SPORE_TURN_SPEED;
     data.sensor_distance = SimulationDefaults::SPORE_SENSOR_DISTANCE;
     data.sensor_angle = SimulationDefaults::SPORE_SENSOR_ANGLE;
+    data.diffusion_rate = SimulationDefaults::TRAIL_DIFFUSION_RATE;
+    data.grid_resize_factor = 1.0f;
+    data.seed = SimulationDefaults::SEED;
     data.aspect_ratio = aspectRatio;
 }
 
@@ -45,6 +202,38 @@ MoldLabGame::MoldLabGame(const int width, const int height, const std::string &t
         addShaderDefinition(WRAP_GRID_DEFINITION, "");
     }
     addShaderDefinition(SPORE_DEFINITION, "include/Spore.h");
+    addShaderDefinition(OCCUPANCY_DEFINITION, "include/OccupancyData.h");
+    addShaderDefinition(RAY_MARCHING_DEFINITION, "shaders/ray_marching.glsl");
+    addShaderDefinition(TRAIL_ACCESS_DEFINITION, "shaders/trail_access.glsl");
+    addShaderDefinition(VOXEL_INSTANCES_DEFINITION, "include/VoxelInstances.h");
+    addShaderDefinition(CHECKERBOARD_PATTERN_DEFINITION, "shaders/checkerboard.glsl");
+    addShaderDefinition(MARCH_STATISTICS_DEFINITION, "include/MarchStatistics.h");
+    addShaderDefinition(TRAIL_LOD_DEFINITION, "shaders/trail_lod.glsl");
+    addShaderDefinition(DEPOSIT_STATISTICS_DEFINITION, "include/DepositStatistics.h");
+    addShaderDefinition(ENSEMBLE_MEMBERS_DEFINITION, "shaders/ensemble.glsl");
+    addShaderDefinition(TRAIL_METRICS_DEFINITION, "include/TrailMetrics.h");
+    addShaderDefinition(RANDOM_NUMBERS_DEFINITION, "include/Random.h");
+    addShaderDefinition(TRAIL_DIFFUSION_DEFINITION, "include/TrailDiffusion.h");
+    addShaderDefinition(SPORE_POPULATION_DEFINITION, "include/SporePopulation.h");
+    setShaderVariant(PYRAMID_SKIPPING_DEFINITION, usePyramidSkipping);
+    setShaderVariant(DEPTH_PREPASS_DEFINITION, useDepthPrepass);
+    setShaderVariant(BAKED_DENSITY_DEFINITION, useBakedDensity);
+    setShaderVariant(TRAIL_SAMPLER_DEFINITION, useTrailSampler);
+    setShaderVariant(TRILINEAR_SENSING_DEFINITION, useTrilinearSensing);
+    setShaderVariant(CHECKERBOARD_DEFINITION, useCheckerboard);
+    setShaderVariant(QUARTER_CHECKERBOARD_DEFINITION, useQuarterCheckerboard);
+    setShaderVariant(USE_MARCH_STATISTICS_DEFINITION, useMarchStatistics);
+    setShaderVariant(USE_TRAIL_LOD_DEFINITION, useTrailLod);
+    setShaderVariant(LOD_SENSING_DEFINITION, useLodSensing);
+    setShaderVariant(DIFFUSION_DEFINITION, useDiffusion);
+    setShaderVariant(SPORE_LIFECYCLE_DEFINITION, useSporeLifecycle);
+    // Only on while initializeEnsembleShaders() builds the ensemble's passes
+    setShaderVariant(ENSEMBLE_DEFINITION, false);
+
+    // Bindings 0 to 7 are taken by the other passes, the lifecycle needs a driver that offers more
+    GLint maxStorageBindings = 0;
+    glGetIntegerv(GL_MAX_SHADER_STORAGE_BUFFER_BINDINGS, &maxStorageBindings);
+    sporeLifecycleSupported = maxStorageBindings >= LIFECYCLE_BUFFER_BINDINGS;
 
     // Set the simulation Settings to the Defaults
     assignDefaultsToSimulationData(simulationSettings,  static_cast<float>(getScreenWidth()) / static_cast<float>(getScreenHeight()));
@@ -65,6 +254,50 @@ MoldLabGame::~MoldLabGame() {
         glDeleteTextures(1, &sdfTexBuffer1);
     if (sdfTexBuffer2)
         glDeleteTextures(1, &sdfTexBuffer2);
+    if (occupancyTexture)
+        glDeleteTextures(1, &occupancyTexture);
+    if (trailPyramidTexture)
+        glDeleteTextures(1, &trailPyramidTexture);
+    if (renderTexture)
+        glDeleteTextures(1, &renderTexture);
+    if (renderFramebuffer)
+        glDeleteFramebuffers(1, &renderFramebuffer);
+    if (depthPrepassTexture)
+        glDeleteTextures(1, &depthPrepassTexture);
+    if (bakedDensityTexture)
+        glDeleteTextures(1, &bakedDensityTexture);
+    if (voxelDrawBuffer)
+        glDeleteBuffers(1, &voxelDrawBuffer);
+    if (voxelInstanceBuffer)
+        glDeleteBuffers(1, &voxelInstanceBuffer);
+    if (voxelInstanceVao)
+        glDeleteVertexArrays(1, &voxelInstanceVao);
+    if (trailReadFramebuffer)
+        glDeleteFramebuffers(1, &trailReadFramebuffer);
+    if (accumulationTexture)
+        glDeleteTextures(1, &accumulationTexture);
+    if (accumulationFramebuffer)
+        glDeleteFramebuffers(1, &accumulationFramebuffer);
+    if (checkerboardDepthTexture)
+        glDeleteTextures(1, &checkerboardDepthTexture);
+    if (checkerboardHistoryTexture)
+        glDeleteTextures(1, &checkerboardHistoryTexture);
+    if (marchStatisticsBuffer)
+        glDeleteBuffers(1, &marchStatisticsBuffer);
+    if (trailLodTexture)
+        glDeleteTextures(1, &trailLodTexture);
+    if (depositStatisticsBuffer)
+        glDeleteBuffers(1, &depositStatisticsBuffer);
+    if (trailMetricsBuffer)
+        glDeleteBuffers(1, &trailMetricsBuffer);
+    if (sporePopulationBuffer)
+        glDeleteBuffers(1, &sporePopulationBuffer);
+    if (sporesBackBuffer)
+        glDeleteBuffers(1, &sporesBackBuffer);
+    if (sporeSnapshotBuffer)
+        glDeleteBuffers(1, &sporeSnapshotBuffer);
+    if (sporeScanBuffer)
+        glDeleteBuffers(1, &sporeScanBuffer);
 
     std::cout << "Exiting..." << std::endl;
 }
@@ -79,9 +312,69 @@ void MoldLabGame::initializeRenderShader(bool useTransparency) {
         removeShaderDefinition(USE_TRANSPARENCY_DEFINITION);
     }
 
+    if (shaderProgram) {
+        glDeleteProgram(shaderProgram);
+    }
+
     shaderProgram = CreateShaderProgram({
         {"shaders/renderer.glsl", GL_VERTEX_SHADER, true} // Combined vertex and fragment shaders
     });
+    pixelJitterSV = ShaderVariable(shaderProgram, &pixelJitter, "pixelJitter");
+
+    // Frames rendered with the old variants are stale
+    ++renderShaderGeneration;
+
+    // The compute renderer shares the ray marching and its variants
+    if (renderComputeShaderProgram) {
+        glDeleteProgram(renderComputeShaderProgram);
+    }
+
+    renderComputeShaderProgram = CreateShaderProgram({
+        {"shaders/render_compute.glsl", GL_COMPUTE_SHADER, false}
+    });
+    computePixelJitterSV = ShaderVariable(renderComputeShaderProgram, &pixelJitter, "pixelJitter");
+
+    // Only built with the variant, its uniforms do not exist otherwise
+    if (checkerboardResolveShaderProgram) {
+        glDeleteProgram(checkerboardResolveShaderProgram);
+        checkerboardResolveShaderProgram = 0;
+    }
+
+    if (useCheckerboard) {
+        checkerboardFrameSV = ShaderVariable(shaderProgram, &checkerboardFrame, "checkerboardFrame");
+        computeCheckerboardFrameSV = ShaderVariable(renderComputeShaderProgram, &checkerboardFrame, "checkerboardFrame");
+
+        checkerboardResolveShaderProgram = CreateShaderProgram({
+            {"shaders/checkerboard_resolve.glsl", GL_COMPUTE_SHADER, false}
+        });
+        resolveCheckerboardFrameSV = ShaderVariable(checkerboardResolveShaderProgram, &checkerboardFrame, "checkerboardFrame");
+        checkerboardHistoryValidSV = ShaderVariable(checkerboardResolveShaderProgram, &checkerboardHistoryValid, "historyValid");
+        previousCameraPositionSV = ShaderVariable(checkerboardResolveShaderProgram, &previousCameraPosition, "previousCameraPosition");
+        previousCameraFocusSV = ShaderVariable(checkerboardResolveShaderProgram, &previousCameraFocus, "previousCameraFocus");
+    }
+
+    // Only the transparent march steps through the mean chain
+    if (useTrailLod && useTransparency) {
+        trailLodDistanceSV = ShaderVariable(shaderProgram, &trailLodDistance, "trailLodDistance");
+        computeTrailLodDistanceSV = ShaderVariable(renderComputeShaderProgram, &trailLodDistance, "trailLodDistance");
+    }
+
+    if (depthPrepassShaderProgram) {
+        glDeleteProgram(depthPrepassShaderProgram);
+    }
+
+    depthPrepassShaderProgram = CreateShaderProgram({
+        {"shaders/depth_prepass.glsl", GL_COMPUTE_SHADER, false}
+    });
+    depthPrepassScreenSizeSV = ShaderVariable(depthPrepassShaderProgram, &depthPrepassScreenSize, "screenSize");
+
+    if (bakeDensityShaderProgram) {
+        glDeleteProgram(bakeDensityShaderProgram);
+    }
+
+    bakeDensityShaderProgram = CreateShaderProgram({
+        {"shaders/bake_density.glsl", GL_COMPUTE_SHADER, false}
+    });
 }
 
 void MoldLabGame::initializeMoveSporesShader(bool wrapAround) {
@@ -91,25 +384,123 @@ void MoldLabGame::initializeMoveSporesShader(bool wrapAround) {
         removeShaderDefinition(WRAP_GRID_DEFINITION);
     }
 
+    if (moveSporesShaderProgram) {
+        glDeleteProgram(moveSporesShaderProgram);
+    }
+
     moveSporesShaderProgram = CreateShaderProgram({
         {"shaders/move_spores.glsl", GL_COMPUTE_SHADER, false}
     });
+
+    // Measures motion through the same faces the spores wrap around
+    if (sporeMetricsShaderProgram) {
+        glDeleteProgram(sporeMetricsShaderProgram);
+    }
+
+    sporeMetricsShaderProgram = CreateShaderProgram({
+        {"shaders/spore_metrics.glsl", GL_COMPUTE_SHADER, false}
+    });
+    snapshotAgeSV = ShaderVariable(sporeMetricsShaderProgram, &snapshotAge, "snapshotAge");
+
+    // The ensemble's sensing follows the same options
+    if (useEnsemble) {
+        initializeEnsembleShaders();
+    }
 }
 
-void MoldLabGame::initializeShaders() {
-    initializeRenderShader(useTransparency);
+void MoldLabGame::initializeSporePassShaders() {
+    // Both depend on whether the live spore count comes from the lifecycle or the settings
+    if (drawSporesShaderProgram) {
+        glDeleteProgram(drawSporesShaderProgram);
+    }
 
-    // Initialize the compute shaders
     drawSporesShaderProgram = CreateShaderProgram({
         {"shaders/draw_spores.glsl", GL_COMPUTE_SHADER, false}
     });
 
-    initializeMoveSporesShader(wrapGrid);
+    if (depositSporesShaderProgram) {
+        glDeleteProgram(depositSporesShaderProgram);
+    }
+
+    depositSporesShaderProgram = CreateShaderProgram({
+        {"shaders/deposit_spores.glsl", GL_COMPUTE_SHADER, false}
+    });
+    depositAmountSV = ShaderVariable(depositSporesShaderProgram, &depositAmount, "depositAmount");
+}
+
+void MoldLabGame::initializeDecayShaders() {
+    // Both depend on the wrapping, the decay also on whether it finishes the diffusion
+    if (decaySporesShaderProgram) {
+        glDeleteProgram(decaySporesShaderProgram);
+    }
 
     decaySporesShaderProgram = CreateShaderProgram({
         {"shaders/decay_spores.glsl", GL_COMPUTE_SHADER, false}
     });
 
+    if (diffuseTrailShaderProgram) {
+        glDeleteProgram(diffuseTrailShaderProgram);
+    }
+
+    diffuseTrailShaderProgram = CreateShaderProgram({
+        {"shaders/diffuse_trail.glsl", GL_COMPUTE_SHADER, false}
+    });
+    diffusionAxisSV = ShaderVariable(diffuseTrailShaderProgram, &diffusionAxis, "diffusionAxis");
+}
+
+void MoldLabGame::initializeEnsembleShaders() {
+    // Members have no mip chain of their own and no diffusion pass, their sensing and decay leave both out. Their
+    // spore counts are fixed.
+    setShaderVariant(ENSEMBLE_DEFINITION, true);
+    setShaderVariant(LOD_SENSING_DEFINITION, false);
+    setShaderVariant(DIFFUSION_DEFINITION, false);
+    setShaderVariant(SPORE_LIFECYCLE_DEFINITION, false);
+
+    for (const GLuint program : {ensemblePrograms.randomizeSpores, ensemblePrograms.moveSpores, ensemblePrograms.drawSpores,
+                                 ensemblePrograms.decaySpores, ensemblePrograms.clearGrid, ensembleProjectTrailShaderProgram}) {
+        if (program) {
+            glDeleteProgram(program);
+        }
+    }
+
+    ensemblePrograms.randomizeSpores = CreateShaderProgram({
+        {"shaders/randomize_spores.glsl", GL_COMPUTE_SHADER, false}
+    });
+    ensemblePrograms.moveSpores = CreateShaderProgram({
+        {"shaders/move_spores.glsl", GL_COMPUTE_SHADER, false}
+    });
+    ensemblePrograms.drawSpores = CreateShaderProgram({
+        {"shaders/draw_spores.glsl", GL_COMPUTE_SHADER, false}
+    });
+    ensemblePrograms.decaySpores = CreateShaderProgram({
+        {"shaders/decay_spores.glsl", GL_COMPUTE_SHADER, false}
+    });
+    ensemblePrograms.clearGrid = CreateShaderProgram({
+        {"shaders/clear_grid.glsl", GL_COMPUTE_SHADER, false}
+    });
+    ensembleProjectTrailShaderProgram = CreateShaderProgram({
+        {"shaders/project_trail.glsl", GL_COMPUTE_SHADER, false}
+    });
+
+    setShaderVariant(ENSEMBLE_DEFINITION, false);
+    setShaderVariant(LOD_SENSING_DEFINITION, useLodSensing);
+    setShaderVariant(DIFFUSION_DEFINITION, useDiffusion);
+    setShaderVariant(SPORE_LIFECYCLE_DEFINITION, useSporeLifecycle);
+
+    ensemble.setPrograms(ensemblePrograms);
+    ensembleProjection.setProgram(ensembleProjectTrailShaderProgram);
+}
+
+void MoldLabGame::initializeShaders() {
+    initializeRenderShader(useTransparency);
+
+    // Initialize the compute shaders
+    initializeSporePassShaders();
+
+    initializeMoveSporesShader(wrapGrid);
+
+    initializeDecayShaders();
+
     jumpFloodInitShaderProgram = CreateShaderProgram({
         {"shaders/jump_flood_init.glsl", GL_COMPUTE_SHADER, false}
     });
@@ -129,6 +520,47 @@ void MoldLabGame::initializeShaders() {
     scaleSporesShaderProgram = CreateShaderProgram({
     {"shaders/scale_spores.glsl", GL_COMPUTE_SHADER, false}
     });
+
+    buildTrailPyramidShaderProgram = CreateShaderProgram({
+    {"shaders/build_trail_pyramid.glsl", GL_COMPUTE_SHADER, false}
+    });
+
+    buildTrailLodShaderProgram = CreateShaderProgram({
+    {"shaders/build_trail_lod.glsl", GL_COMPUTE_SHADER, false}
+    });
+
+    compactVoxelsShaderProgram = CreateShaderProgram({
+    {"shaders/compact_voxels.glsl", GL_COMPUTE_SHADER, false}
+    });
+
+    voxelInstancesShaderProgram = CreateShaderProgram({
+        {"shaders/voxel_instances.glsl", GL_VERTEX_SHADER, true} // Combined vertex and fragment shaders
+    });
+
+    upscaleShaderProgram = CreateShaderProgram({
+        {"shaders/upscale.glsl", GL_VERTEX_SHADER, true} // Combined vertex and fragment shaders
+    });
+
+    projectTrailShaderProgram = CreateShaderProgram({
+    {"shaders/project_trail.glsl", GL_COMPUTE_SHADER, false}
+    });
+    trailProjection.setProgram(projectTrailShaderProgram);
+
+    projectionViewShaderProgram = CreateShaderProgram({
+        {"shaders/projection_view.glsl", GL_VERTEX_SHADER, true} // Combined vertex and fragment shaders
+    });
+
+    trailMetricsShaderProgram = CreateShaderProgram({
+    {"shaders/trail_metrics.glsl", GL_COMPUTE_SHADER, false}
+    });
+
+    sporeLifecycleShaderProgram = CreateShaderProgram({
+    {"shaders/spore_lifecycle.glsl", GL_COMPUTE_SHADER, false}
+    });
+
+    resampleTrailShaderProgram = CreateShaderProgram({
+    {"shaders/resample_trail.glsl", GL_COMPUTE_SHADER, false}
+    });
 }
 
 
@@ -138,6 +570,26 @@ void MoldLabGame::initializeUniformVariables() {
 
     jfaStepSV = ShaderVariable(jumpFloodStepShaderProgram, &jfaStep, "stepSize");
     maxSporeSizeSV = ShaderVariable(scaleSporesShaderProgram, &maxSporeSize, "maxSporeSize");
+
+    static int pyramidLevel = 0;
+    pyramidLevelSV = ShaderVariable(buildTrailPyramidShaderProgram, &pyramidLevel, "pyramidLevel");
+
+    static int lodLevel = 0;
+    lodLevelSV = ShaderVariable(buildTrailLodShaderProgram, &lodLevel, "lodLevel");
+
+    lifecycleStageSV = ShaderVariable(sporeLifecycleShaderProgram, &lifecycleStage, "lifecycleStage");
+    lifecycleStepSV = ShaderVariable(sporeLifecycleShaderProgram, &lifecycleStep, "lifecycleStep");
+    crowdingTrailSV = ShaderVariable(sporeLifecycleShaderProgram, &crowdingTrail, "crowdingTrail");
+    sporeDeathRateSV = ShaderVariable(sporeLifecycleShaderProgram, &sporeDeathRate, "deathRate");
+    spawnTrailSV = ShaderVariable(sporeLifecycleShaderProgram, &spawnTrail, "spawnTrail");
+    sporeSpawnRateSV = ShaderVariable(sporeLifecycleShaderProgram, &sporeSpawnRate, "spawnRate");
+
+    voxelThresholdSV = ShaderVariable(compactVoxelsShaderProgram, &voxelThreshold, "voxelThreshold");
+    projectionExposureSV = ShaderVariable(projectionViewShaderProgram, &projectionExposure, "exposure");
+    projectionViewScaleSV = ShaderVariable(projectionViewShaderProgram, &projectionViewScale, "viewScale");
+    voxelViewProjectionSV = ShaderVariable(voxelInstancesShaderProgram, &voxelViewProjection, "viewProjection");
+    voxelCameraPositionSV = ShaderVariable(voxelInstancesShaderProgram, &voxelCameraPosition, "cameraPosition");
+    voxelCameraCutoutRadiusSV = ShaderVariable(voxelInstancesShaderProgram, &voxelCameraCutoutRadius, "cameraCutoutRadius");
 }
 
 
@@ -169,9 +621,9 @@ void MoldLabGame::initializeVoxelGridBuffer() {
     // Allocate storage for the 3D texture
     glTexStorage3D(GL_TEXTURE_3D, 1, GL_R32F, voxelGridSize, voxelGridSize, voxelGridSize);
 
-    // Set texture parameters
-    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    // Set texture parameters, linear only affects trilinear sensing since texelFetch ignores filtering
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
@@ -180,12 +632,192 @@ void MoldLabGame::initializeVoxelGridBuffer() {
     glBindImageTexture(GRID_TEXTURE_LOCATION, voxelGridTexture, 0, GL_TRUE, 0, GL_READ_WRITE, GL_R32F);
 
     glBindTexture(GL_TEXTURE_3D, 0); // Unbind the texture
+
+    // Also a sampler for the passes that only read the trail (trail_access.glsl)
+    glActiveTexture(GL_TEXTURE0 + TRAIL_TEXTURE_UNIT);
+    glBindTexture(GL_TEXTURE_3D, voxelGridTexture);
+    glActiveTexture(GL_TEXTURE0);
+}
+
+void MoldLabGame::initializeOccupancyBuffer() {
+    // ** Create Occupancy Bitmask Texture, one 32 bit word per brick of voxels **
+    glGenTextures(1, &occupancyTexture);
+    glBindTexture(GL_TEXTURE_3D, occupancyTexture);
+
+    glTexStorage3D(GL_TEXTURE_3D, 1, GL_R32UI, OCCUPANCY_BRICKS_X, OCCUPANCY_BRICKS_Y, OCCUPANCY_BRICKS_Z);
+
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    // Written by decay/draw/clear, read by the JFA init and the renderer
+    glBindImageTexture(OCCUPANCY_TEXTURE_LOCATION, occupancyTexture, 0, GL_TRUE, 0, GL_READ_WRITE, GL_R32UI);
+
+    glBindTexture(GL_TEXTURE_3D, 0);
+}
+
+void MoldLabGame::initializeTrailPyramidBuffer() {
+    // Power of two base so every level still covers the whole grid after rounding down
+    int pyramidBaseSize = 1;
+    while (pyramidBaseSize * 2 < SimulationDefaults::MAX_GRID_SIZE) {
+        pyramidBaseSize *= 2;
+    }
+
+    // ** Create Min/Max Trail Pyramid Texture **
+    glGenTextures(1, &trailPyramidTexture);
+    glBindTexture(GL_TEXTURE_3D, trailPyramidTexture);
+
+    glTexStorage3D(GL_TEXTURE_3D, TRAIL_PYRAMID_LEVELS, GL_RG16F, pyramidBaseSize, pyramidBaseSize, pyramidBaseSize);
+
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+
+    glBindTexture(GL_TEXTURE_3D, 0);
+
+    // The renderer reads every level through a sampler
+    glActiveTexture(GL_TEXTURE0 + TRAIL_PYRAMID_TEXTURE_UNIT);
+    glBindTexture(GL_TEXTURE_3D, trailPyramidTexture);
+    glActiveTexture(GL_TEXTURE0);
+}
+
+void MoldLabGame::initializeBakedDensityBuffer() {
+    // One texel more than the grid per side, the last one holds the distance just past the far faces
+    int bakedDensitySize = SimulationDefaults::MAX_GRID_SIZE + 1;
+
+    // ** Create Baked Density Texture, the smoothed surface the opaque renderer samples **
+    glGenTextures(1, &bakedDensityTexture);
+    glBindTexture(GL_TEXTURE_3D, bakedDensityTexture);
+
+    glTexStorage3D(GL_TEXTURE_3D, 1, GL_R16F, bakedDensitySize, bakedDensitySize, bakedDensitySize);
+
+    // Trilinear filtering does the blending between voxel centres
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+
+    glBindTexture(GL_TEXTURE_3D, 0);
+
+    glActiveTexture(GL_TEXTURE0 + BAKED_DENSITY_TEXTURE_UNIT);
+    glBindTexture(GL_TEXTURE_3D, bakedDensityTexture);
+    glActiveTexture(GL_TEXTURE0);
+}
+
+
+void MoldLabGame::initializeRenderTarget(const int width, const int height) {
+    if (renderTexture) {
+        glDeleteTextures(1, &renderTexture);
+    }
+
+    // ** Create Offscreen Render Target, written by the ray marchers below window resolution **
+    glGenTextures(1, &renderTexture);
+    glBindTexture(GL_TEXTURE_2D, renderTexture);
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, width, height);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    // Read framebuffer for presenting it with a blit
+    if (!renderFramebuffer) {
+        glGenFramebuffers(1, &renderFramebuffer);
+    }
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, renderFramebuffer);
+    glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, renderTexture, 0);
+    if (glCheckFramebufferStatus(GL_READ_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "Render target framebuffer is incomplete" << std::endl;
+    }
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+
+    // Running average of the jittered samples for progressive refinement, wider than the target to avoid banding
+    if (accumulationTexture) {
+        glDeleteTextures(1, &accumulationTexture);
+    }
+    glGenTextures(1, &accumulationTexture);
+    glBindTexture(GL_TEXTURE_2D, accumulationTexture);
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA16F, width, height);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    if (!accumulationFramebuffer) {
+        glGenFramebuffers(1, &accumulationFramebuffer);
+    }
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, accumulationFramebuffer);
+    glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, accumulationTexture, 0);
+    if (glCheckFramebufferStatus(GL_DRAW_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "Accumulation framebuffer is incomplete" << std::endl;
+    }
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+
+    // The edge-aware upscale samples it
+    glActiveTexture(GL_TEXTURE0 + RENDER_TARGET_TEXTURE_UNIT);
+    glBindTexture(GL_TEXTURE_2D, renderTexture);
+    glActiveTexture(GL_TEXTURE0);
+
+    renderTextureWidth = width;
+    renderTextureHeight = height;
+}
+
+void MoldLabGame::initializeDepthPrepassTarget(const int tilesX, const int tilesY) {
+    if (depthPrepassTexture) {
+        glDeleteTextures(1, &depthPrepassTexture);
+    }
+
+    // ** Create Depth Prepass Texture, one empty distance per screen tile **
+    glGenTextures(1, &depthPrepassTexture);
+    glBindTexture(GL_TEXTURE_2D, depthPrepassTexture);
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_R32F, tilesX, tilesY);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    depthPrepassWidth = tilesX;
+    depthPrepassHeight = tilesY;
 }
 
+void MoldLabGame::initializeCheckerboardTargets(const int width, const int height) {
+    if (checkerboardDepthTexture) {
+        glDeleteTextures(1, &checkerboardDepthTexture);
+    }
+    if (checkerboardHistoryTexture) {
+        glDeleteTextures(1, &checkerboardHistoryTexture);
+    }
+
+    // ** Create Checkerboard Targets, the marched pixels' depths and the last finished frame **
+    glGenTextures(1, &checkerboardDepthTexture);
+    glBindTexture(GL_TEXTURE_2D, checkerboardDepthTexture);
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_R32F, width, height);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    // Reprojected pixels land between texels, filtered fetches
+    glGenTextures(1, &checkerboardHistoryTexture);
+    glBindTexture(GL_TEXTURE_2D, checkerboardHistoryTexture);
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, width, height);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glActiveTexture(GL_TEXTURE0 + CHECKERBOARD_HISTORY_TEXTURE_UNIT);
+    glBindTexture(GL_TEXTURE_2D, checkerboardHistoryTexture);
+    glActiveTexture(GL_TEXTURE0);
+
+    checkerboardTargetWidth = width;
+    checkerboardTargetHeight = height;
+}
 
 void MoldLabGame::initializeSDFBuffer() {
      int reducedGridSize = simulationSettings.grid_size / simulationSettings.sdf_reduction;
 
+    // Sized for the grid, reallocated when it is resized
+    if (sdfTexBuffer1)
+        glDeleteTextures(1, &sdfTexBuffer1);
+    if (sdfTexBuffer2)
+        glDeleteTextures(1, &sdfTexBuffer2);
+
     glGenTextures(1, &sdfTexBuffer1);
     glBindTexture(GL_TEXTURE_3D, sdfTexBuffer1);
     glTexStorage3D(GL_TEXTURE_3D, 1, GL_RGBA32F, reducedGridSize, reducedGridSize, reducedGridSize);
@@ -214,8 +846,11 @@ void MoldLabGame::initializeSDFBuffer() {
 }
 
 
-void uploadSettingsBuffer(GLuint simulationSettingsBuffer, const SimulationData &settings) {
-    glGenBuffers(1, &simulationSettingsBuffer);
+void uploadSettingsBuffer(GLuint &simulationSettingsBuffer, const SimulationData &settings) {
+    // Created once, refilled every step
+    if (!simulationSettingsBuffer) {
+        glGenBuffers(1, &simulationSettingsBuffer);
+    }
     glBindBuffer(GL_SHADER_STORAGE_BUFFER, simulationSettingsBuffer);
     glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(SimulationData), &settings, GL_STATIC_DRAW);
     glBindBufferBase(GL_SHADER_STORAGE_BUFFER, SIMULATION_BUFFER_LOCATION, simulationSettingsBuffer); // Binding index 2 for settings
@@ -237,6 +872,152 @@ void MoldLabGame::initializeSimulationBuffers() {
     uploadSettingsBuffer(simulationSettingsBuffer, simulationSettings);
 }
 
+void MoldLabGame::initializeVoxelInstanceBuffers() {
+    // ** Indirect Draw Command, its instance count is written by the compaction **
+    glGenBuffers(1, &voxelDrawBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, voxelDrawBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(VoxelDrawCommand), nullptr, GL_DYNAMIC_DRAW);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, VOXEL_DRAW_BUFFER_LOCATION, voxelDrawBuffer);
+
+    // ** Voxel Instances, two words each **
+    glGenBuffers(1, &voxelInstanceBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, voxelInstanceBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(GLuint) * 2 * MAX_VOXEL_INSTANCES, nullptr, GL_DYNAMIC_DRAW);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, VOXEL_INSTANCE_BUFFER_LOCATION, voxelInstanceBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    // The same buffer feeds the cubes as a per-instance attribute
+    glGenVertexArrays(1, &voxelInstanceVao);
+    glBindVertexArray(voxelInstanceVao);
+    glBindBuffer(GL_ARRAY_BUFFER, voxelInstanceBuffer);
+    glEnableVertexAttribArray(0);
+    glVertexAttribIPointer(0, 2, GL_UNSIGNED_INT, 0, nullptr);
+    glVertexAttribDivisor(0, 1);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void MoldLabGame::initializeMarchStatisticsBuffer() {
+    // ** March Statistics, cleared before and read back after every ray marched frame **
+    glGenBuffers(1, &marchStatisticsBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, marchStatisticsBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(MarchStatistics), nullptr, GL_DYNAMIC_COPY);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, MARCH_STATISTICS_BUFFER_LOCATION, marchStatisticsBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+void MoldLabGame::initializeDepositStatisticsBuffer() {
+    // ** Deposit Statistics, cleared before and read back after every binned deposit **
+    glGenBuffers(1, &depositStatisticsBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, depositStatisticsBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(DepositStatistics), nullptr, GL_DYNAMIC_COPY);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, DEPOSIT_STATISTICS_BUFFER_LOCATION, depositStatisticsBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+void MoldLabGame::initializeTrailMetricsBuffers() {
+    if (trailMetricsBuffer)
+        glDeleteBuffers(1, &trailMetricsBuffer);
+    if (sporeSnapshotBuffer)
+        glDeleteBuffers(1, &sporeSnapshotBuffer);
+
+    // ** Trail Metrics, reset before and read back after every measurement **
+    glGenBuffers(1, &trailMetricsBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, trailMetricsBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(TrailMetrics), nullptr, GL_DYNAMIC_COPY);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, TRAIL_METRICS_BUFFER_LOCATION, trailMetricsBuffer);
+
+    // ** Spore Snapshot, every spore's position and heading at the last measurement **
+    sporeSnapshotCapacity = simulationSettings.spore_count;
+    glGenBuffers(1, &sporeSnapshotBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, sporeSnapshotBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, SPORE_SNAPSHOT_SIZE * sporeSnapshotCapacity, nullptr, GL_DYNAMIC_COPY);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, SPORE_SNAPSHOT_BUFFER_LOCATION, sporeSnapshotBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    snapshotSporeCount = 0;
+}
+
+void MoldLabGame::initializeSporeLifecycleBuffers() {
+    // Room for the population to double, as far as one indirect dispatch of the move pass reaches
+    const uint32_t initialCount = std::min<uint32_t>(simulationSettings.spore_count, MAX_LIFECYCLE_SPORES);
+    sporeCapacity = std::min<uint32_t>(2 * initialCount, MAX_LIFECYCLE_SPORES);
+    // The passes outside the lifecycle still cover the settings' count, which can be above it. The buffers swap
+    // places, so both hold either.
+    sporeBufferCount = std::max<uint32_t>(sporeCapacity, simulationSettings.spore_count);
+    const GLsizeiptr sporesSize = sizeof(Spore) * sporeBufferCount;
+    const GLuint lifecycleGroupCount = (sporeCapacity + SPORE_LIFECYCLE_GROUP_SIZE - 1) / SPORE_LIFECYCLE_GROUP_SIZE;
+
+    // ** Spores, grown to the capacity with the current ones carried over **
+    GLuint grownSporesBuffer = 0;
+    glGenBuffers(1, &grownSporesBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, grownSporesBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, sporesSize, nullptr, GL_DYNAMIC_DRAW);
+
+    GLint64 previousSize = 0;
+    glBindBuffer(GL_COPY_READ_BUFFER, sporesBuffer);
+    glGetBufferParameteri64v(GL_COPY_READ_BUFFER, GL_BUFFER_SIZE, &previousSize);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_SHADER_STORAGE_BUFFER, 0, 0, std::min<GLint64>(previousSize, sporesSize));
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+
+    glDeleteBuffers(1, &sporesBuffer);
+    sporesBuffer = grownSporesBuffer;
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, SPORE_BUFFER_LOCATION, sporesBuffer);
+
+    // ** Next Spores, the lifecycle compacts into them and they swap places with the spores **
+    if (sporesBackBuffer)
+        glDeleteBuffers(1, &sporesBackBuffer);
+    glGenBuffers(1, &sporesBackBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, sporesBackBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, sporesSize, nullptr, GL_DYNAMIC_COPY);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, NEXT_SPORES_BUFFER_LOCATION, sporesBackBuffer);
+
+    // ** Spore Scan, a word per spore and one per work group **
+    if (sporeScanBuffer)
+        glDeleteBuffers(1, &sporeScanBuffer);
+    glGenBuffers(1, &sporeScanBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, sporeScanBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(GLuint) * (sporeCapacity + lifecycleGroupCount), nullptr, GL_DYNAMIC_COPY);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, SPORE_SCAN_BUFFER_LOCATION, sporeScanBuffer);
+
+    // ** Spore Population, written by resetSporePopulation() and from then on only by the GPU **
+    if (!sporePopulationBuffer) {
+        glGenBuffers(1, &sporePopulationBuffer);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, sporePopulationBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(SporePopulation), nullptr, GL_DYNAMIC_COPY);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, SPORE_POPULATION_BUFFER_LOCATION, sporePopulationBuffer);
+    }
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+void MoldLabGame::initializeTrailLodBuffer() {
+    // Power of two base like the pyramid, so one normalized coordinate addresses the same point on every level
+    int lodBaseSize = 1;
+    while (lodBaseSize * 2 < SimulationDefaults::MAX_GRID_SIZE) {
+        lodBaseSize *= 2;
+    }
+
+    // ** Create Mean Trail Chain Texture **
+    glGenTextures(1, &trailLodTexture);
+    glBindTexture(GL_TEXTURE_3D, trailLodTexture);
+
+    glTexStorage3D(GL_TEXTURE_3D, TRAIL_LOD_LEVELS, GL_R16F, lodBaseSize, lodBaseSize, lodBaseSize);
+
+    // Filtered within and between levels, fractional levels blend smoothly as the distance grows
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+
+    glBindTexture(GL_TEXTURE_3D, 0);
+
+    // Sensing and the renderer read it through a sampler
+    glActiveTexture(GL_TEXTURE0 + TRAIL_LOD_TEXTURE_UNIT);
+    glBindTexture(GL_TEXTURE_3D, trailLodTexture);
+    glActiveTexture(GL_TEXTURE0);
+}
+
 
 // ============================
 // Update Helpers
@@ -298,90 +1079,597 @@ void MoldLabGame::resetSporesAndGrid() const {
     DispatchComputeShader(randomizeSporesShaderProgram, simulationSettings.spore_count, 1, 1);
 }
 
+// Carries the run over to the new grid size instead of starting it over. The trail is resampled trilinearly from a
+// copy at the old size, the spores are scaled by the same factor. Without the memory for the copy the run starts over.
+void MoldLabGame::resampleGrid() {
+    const int gridSize = simulationSettings.grid_size;
 
-void MoldLabGame::DispatchComputeShaders() {
-    int gridSize = simulationSettings.grid_size;
-
-    uploadSettingsBuffer(simulationSettingsBuffer, simulationSettings);
+    // Reports what earlier calls left, so the check below only sees the allocation's error
+    CheckGLError("before resampling the grid");
 
-    if (!gridSizeChanged) {
-        DispatchComputeShader(decaySporesShaderProgram, gridSize, gridSize, gridSize);
+    GLuint previousTrailTexture = 0;
+    glGenTextures(1, &previousTrailTexture);
+    glBindTexture(GL_TEXTURE_3D, previousTrailTexture);
+    glTexStorage3D(GL_TEXTURE_3D, 1, GL_R32F, trailGridSize, trailGridSize, trailGridSize);
+    const GLenum allocationError = glGetError();
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_3D, 0);
 
-        DispatchComputeShader(moveSporesShaderProgram, simulationSettings.spore_count, 1, 1);
+    if (allocationError != GL_NO_ERROR) {
+        std::cerr << "Warning: No memory to copy the trail for resampling (" << allocationError
+                  << "), resetting the spores and grid at the new size instead." << std::endl;
+        glDeleteTextures(1, &previousTrailTexture);
 
-        DispatchComputeShader(drawSporesShaderProgram, simulationSettings.spore_count, 1, 1);
-    } else {
+        if (useSporeLifecycle) {
+            resetSporePopulation();
+        }
         resetSporesAndGrid();
-    }
+    } else {
+        // Only valid for these passes, nothing else reads a resize factor
+        simulationSettings.grid_resize_factor = static_cast<float>(gridSize) / static_cast<float>(trailGridSize);
+        uploadSettingsBuffer(simulationSettingsBuffer, simulationSettings);
 
-    gridSizeChanged = false;
+        // The copy reads what the last step's image stores wrote
+        glMemoryBarrier(GL_TEXTURE_UPDATE_BARRIER_BIT);
+        glCopyImageSubData(voxelGridTexture, GL_TEXTURE_3D, 0, 0, 0, 0, previousTrailTexture, GL_TEXTURE_3D, 0, 0, 0, 0,
+                           trailGridSize, trailGridSize, trailGridSize);
 
-    executeJFA();
-}
+        glActiveTexture(GL_TEXTURE0 + PREVIOUS_TRAIL_TEXTURE_UNIT);
+        glBindTexture(GL_TEXTURE_3D, previousTrailTexture);
+        glActiveTexture(GL_TEXTURE0);
 
-void MoldLabGame::executeJFA() const {
-    glUseProgram(jumpFloodInitShaderProgram);
+        // Also rebuilds the occupancy bits of the new grid
+        DispatchComputeShader(resampleTrailShaderProgram, gridSize, gridSize, gridSize);
 
-    GLuint readTexture = sdfTexBuffer1;
-    GLuint writeTexture = sdfTexBuffer2; // will be used later
+        // Every slot the lifecycle could have filled, positions past the live count are never read
+        const int sporeCount = useSporeLifecycle ? static_cast<int>(sporeCapacity) : simulationSettings.spore_count;
+        glUseProgram(scaleSporesShaderProgram);
+        *maxSporeSizeSV.value = sporeCount;
+        maxSporeSizeSV.uploadToShader();
+        DispatchComputeShader(scaleSporesShaderProgram, sporeCount, 1, 1);
 
-    glBindImageTexture(SDF_TEXTURE_READ_LOCATION, readTexture, 0, GL_TRUE, 0, GL_WRITE_ONLY, GL_RGBA32F); // set it to write ONLY for initialization
+        glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
 
+        glActiveTexture(GL_TEXTURE0 + PREVIOUS_TRAIL_TEXTURE_UNIT);
+        glBindTexture(GL_TEXTURE_3D, 0);
+        glActiveTexture(GL_TEXTURE0);
+        glDeleteTextures(1, &previousTrailTexture);
 
-     int reducedGridSize = simulationSettings.grid_size / simulationSettings.sdf_reduction;
-    DispatchComputeShader(jumpFloodInitShaderProgram, reducedGridSize, reducedGridSize, reducedGridSize);
-    // inits the read, for later use
-    glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+        simulationSettings.grid_resize_factor = 1.0f;
+    }
 
+    // The distance field is allocated at the reduced grid size
+    initializeSDFBuffer();
 
-    glUseProgram(jumpFloodStepShaderProgram);
+    trailGridSize = gridSize;
+}
 
-    // Start with the largest power of 2 that's less than or equal to reducedGridSize
-    int stepSize = 1;
-    while (stepSize * 2 < reducedGridSize) {
-        stepSize *= 2;
+// The lifecycle starts over from the settings' spore count, the only time the CPU writes the live count
+void MoldLabGame::resetSporePopulation() {
+    const uint32_t initialCount = std::min<uint32_t>(simulationSettings.spore_count, MAX_LIFECYCLE_SPORES);
+    if (sporeCapacity < std::min<uint32_t>(2 * initialCount, MAX_LIFECYCLE_SPORES) ||
+        sporeBufferCount < static_cast<uint32_t>(simulationSettings.spore_count)) {
+        initializeSporeLifecycleBuffers();
     }
 
-    int iterations = 0;
-    int testStopping = 1;
-
-    while (stepSize >= 1) {
-        iterations++;
-        glBindImageTexture(SDF_TEXTURE_READ_LOCATION, readTexture, 0, GL_TRUE, 0, GL_READ_ONLY, GL_RGBA32F);
-        glBindImageTexture(SDF_TEXTURE_WRITE_LOCATION, writeTexture, 0, GL_TRUE, 0, GL_WRITE_ONLY, GL_RGBA32F);
+    SporePopulation population{};
+    population.liveCount = initialCount;
+    population.sporeGroups[0] = (initialCount + SPORE_GROUP_SIZE - 1) / SPORE_GROUP_SIZE;
+    population.lifecycleGroups[0] = (initialCount + SPORE_LIFECYCLE_GROUP_SIZE - 1) / SPORE_LIFECYCLE_GROUP_SIZE;
+    population.sporeGroups[1] = population.sporeGroups[2] = 1;
+    population.lifecycleGroups[1] = population.lifecycleGroups[2] = 1;
+    population.capacity = sporeCapacity;
 
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, sporePopulationBuffer);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(SporePopulation), &population);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
 
-        *jfaStepSV.value = stepSize;
-        jfaStepSV.uploadToShader();
+    latestSporePopulation = population;
+}
 
+// Without the lifecycle the passes cover the settings' spore count again. Past the live count the buffer holds
+// spores that died or were never written, so the count becomes the live one. Waits on the GPU, only when switched off.
+void MoldLabGame::adoptLiveSporeCount() {
+    uint32_t liveCount = 0;
+    glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, sporePopulationBuffer);
+    glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, offsetof(SporePopulation, liveCount), sizeof(uint32_t), &liveCount);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
 
-        DispatchComputeShader(jumpFloodStepShaderProgram, reducedGridSize, reducedGridSize, reducedGridSize);
-        glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
-        stepSize /= 2; // Halve step size
-        std::swap(readTexture, writeTexture);
+    simulationSettings.spore_count = static_cast<int>(std::max<uint32_t>(liveCount, 1));
+    uploadSettingsBuffer(simulationSettingsBuffer, simulationSettings);
 
-        if (iterations == testStopping) {
-            // break;
-        }
+    // A population that died out starts over from a single new spore
+    if (liveCount == 0) {
+        DispatchComputeShader(randomizeSporesShaderProgram, 1, 1, 1);
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
     }
-
-    glBindImageTexture(SDF_TEXTURE_READ_LOCATION, readTexture, 0, GL_TRUE, 0, GL_READ_ONLY, GL_RGBA32F);
-    // set to read after last swap for rendering
 }
 
+// Every member gets the simulation's settings except the swept one, spread evenly over the range from the first
+// member to the last
+SimulationData MoldLabGame::ensembleMemberSettings(const int member) const {
+    SimulationData settings = simulationSettings;
+    settings.grid_size = ensembleGridSize;
+    settings.spore_count = ensembleSporeCount;
 
+    const float position = ensembleMemberCount > 1 ? static_cast<float>(member) / static_cast<float>(ensembleMemberCount - 1) : 0.0f;
+    settings.*ENSEMBLE_SWEPT_PARAMETERS[ensembleSweptParameter] = ensembleSweepRange[0] + (ensembleSweepRange[1] - ensembleSweepRange[0]) * position;
+    return settings;
+}
 
-// ============================
-// Core Lifecycle Functions
-// ============================
-void MoldLabGame::renderingStart() {
-    initializeShaders();
+void MoldLabGame::configureEnsemble() {
+    std::vector<SimulationData> members;
+    for (int member = 0; member < ensembleMemberCount; ++member) {
+        members.push_back(ensembleMemberSettings(member));
+    }
+    ensemble.configure(members);
+    bindSimulationResources();
+}
 
-    initializeUniformVariables();
+// The ensemble binds its own spores, settings and atlas in the same places, the simulation's go back afterwards
+void MoldLabGame::bindSimulationResources() {
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, SPORE_BUFFER_LOCATION, sporesBuffer);
+    uploadSettingsBuffer(simulationSettingsBuffer, simulationSettings);
+    glBindImageTexture(GRID_TEXTURE_LOCATION, voxelGridTexture, 0, GL_TRUE, 0, GL_READ_WRITE, GL_R32F);
+    glBindImageTexture(OCCUPANCY_TEXTURE_LOCATION, occupancyTexture, 0, GL_TRUE, 0, GL_READ_WRITE, GL_R32UI);
 
-    initializeVertexBuffers();
+    glActiveTexture(GL_TEXTURE0 + TRAIL_TEXTURE_UNIT);
+    glBindTexture(GL_TEXTURE_3D, voxelGridTexture);
+    glActiveTexture(GL_TEXTURE0);
+}
 
-    initializeVoxelGridBuffer();
+
+void MoldLabGame::DispatchComputeShaders() {
+    int gridSize = simulationSettings.grid_size;
+
+    uploadSettingsBuffer(simulationSettingsBuffer, simulationSettings);
+
+    // Also catches a resize made while the ensemble ran
+    if (simulationSettings.grid_size != trailGridSize) {
+        resampleGrid();
+        ++trailGeneration;
+        // The spores moved with the grid
+        snapshotSporeCount = 0;
+    } else if (!pauseSimulation) {
+        decayTimer.begin();
+        if (useDiffusion) {
+            diffuseTrail();
+            // One invocation per column, each walks the whole column along z
+            DispatchComputeShader(decaySporesShaderProgram, gridSize, gridSize, 1);
+        } else {
+            DispatchComputeShader(decaySporesShaderProgram, gridSize, gridSize, gridSize);
+        }
+        decayTimer.end();
+
+        // Image writes are only visible to texture fetches after this barrier
+        if (useTrailSampler || useTrilinearSensing) {
+            glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+        }
+
+        moveSporesTimer.begin();
+        dispatchSporePass(moveSporesShaderProgram, SPORE_GROUPS_OFFSET);
+        moveSporesTimer.end();
+
+        // Spores die and spawn where they moved to, the deposit only sees the survivors and the newborns
+        if (useSporeLifecycle) {
+            glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+            stepSporeLifecycle();
+        }
+
+        depositTimer.begin();
+        if (useBinnedDeposit) {
+            depositSpores();
+        } else {
+            dispatchSporePass(drawSporesShaderProgram, SPORE_GROUPS_OFFSET);
+        }
+        depositTimer.end();
+
+        // Occupancy bits from decay/draw are consumed by the JFA init, the trail by the renderers' samplers
+        glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
+        ++trailGeneration;
+
+        ++simulationStep;
+        timeSinceSnapshot += simulationSettings.delta_time;
+        if (useTrailMetrics && simulationStep - lastMeasuredStep >= static_cast<uint32_t>(metricsInterval)) {
+            measureTrailMetrics();
+        }
+    }
+
+    // Rebuilt once per trail change, sensing reads it a step later, before that step's decay
+    if ((useLodSensing || useTrailLod) && trailLodGeneration != trailGeneration) {
+        buildTrailLod();
+    }
+
+    // While paused the passes below would rebuild the same textures, only redo them when something they read changed
+    const DerivedPassInputs derivedPassInputs{trailGeneration, renderShaderGeneration, renderMode, useCpuSdf};
+    if (derivedPassInputs == lastDerivedPassInputs) {
+        return;
+    }
+    lastDerivedPassInputs = derivedPassInputs;
+
+    // The projection views read the trail grid itself
+    if (renderMode == RenderMode::Projection || renderMode == RenderMode::Slice) {
+        return;
+    }
+
+    // Only the opaque renderer sphere traces the smoothed surface
+    if (useBakedDensity && !useTransparency) {
+        bakeDensity();
+    }
+
+    // The compute renderer's tile query always reads the coarsest pyramid level
+    if (usePyramidSkipping || renderMode == RenderMode::Compute) {
+        buildTrailPyramid();
+    }
+
+    if (useCpuSdf) {
+        executeCpuSDF();
+    } else {
+        executeJFA();
+    }
+}
+
+void MoldLabGame::buildTrailPyramid() const {
+    glUseProgram(buildTrailPyramidShaderProgram);
+
+    for (int level = 0; level < TRAIL_PYRAMID_LEVELS; ++level) {
+        if (level > 0) {
+            glBindImageTexture(TRAIL_PYRAMID_READ_LOCATION, trailPyramidTexture, level - 1, GL_TRUE, 0, GL_READ_ONLY, GL_RG16F);
+        }
+        glBindImageTexture(TRAIL_PYRAMID_WRITE_LOCATION, trailPyramidTexture, level, GL_TRUE, 0, GL_WRITE_ONLY, GL_RG16F);
+
+        *pyramidLevelSV.value = level;
+        pyramidLevelSV.uploadToShader();
+
+        const int cellSize = 2 << level;
+        const int levelSize = (simulationSettings.grid_size + cellSize - 1) / cellSize;
+        DispatchComputeShader(buildTrailPyramidShaderProgram, levelSize, levelSize, levelSize);
+        glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+    }
+
+    // The renderer samples the pyramid as a texture
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+}
+
+void MoldLabGame::diffuseTrail() {
+    glUseProgram(diffuseTrailShaderProgram);
+
+    const int gridSize = simulationSettings.grid_size;
+    for (int axis = 0; axis < 2; ++axis) {
+        diffusionAxis = axis;
+        diffusionAxisSV.uploadToShader();
+
+        // One work group per 16 lines of each z slice, the line itself is walked inside the group. Along y every
+        // slice counts as a whole group's worth of items.
+        DispatchComputeShader(diffuseTrailShaderProgram, gridSize, gridSize * DIFFUSION_LINES_PER_GROUP, 1);
+        glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+    }
+}
+
+void MoldLabGame::depositSpores() {
+    // Created on first use
+    if (!depositStatisticsBuffer) {
+        initializeDepositStatisticsBuffer();
+    }
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, depositStatisticsBuffer);
+    glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    // Same storage as image unit 0, R32F and R32UI share a size class so the grid can be viewed as either
+    glBindImageTexture(DEPOSIT_TRAIL_LOCATION, voxelGridTexture, 0, GL_TRUE, 0, GL_READ_WRITE, GL_R32UI);
+
+    glUseProgram(depositSporesShaderProgram);
+    depositAmountSV.uploadToShader();
+    dispatchSporePass(depositSporesShaderProgram, LIFECYCLE_GROUPS_OFFSET);
+
+    // The copy reads what the work groups' atomics wrote
+    glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+    depositStatisticsReadback.queueCopy(depositStatisticsBuffer, sizeof(DepositStatistics));
+}
+
+void MoldLabGame::stepSporeLifecycle() {
+    // Births and deaths count this step only
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, sporePopulationBuffer);
+    glClearBufferSubData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, offsetof(SporePopulation, births), 2 * sizeof(uint32_t),
+                         GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    glUseProgram(sporeLifecycleShaderProgram);
+    ++lifecycleStep;
+    lifecycleStepSV.uploadToShader();
+    crowdingTrailSV.uploadToShader();
+    sporeDeathRateSV.uploadToShader();
+    spawnTrailSV.uploadToShader();
+    sporeSpawnRateSV.uploadToShader();
+
+    // Deciding and scattering cover the live spores, the scan of the work group totals and the commit are one group
+    for (lifecycleStage = 0; lifecycleStage < LIFECYCLE_STAGES; ++lifecycleStage) {
+        lifecycleStageSV.uploadToShader();
+        if (lifecycleStage == 0 || lifecycleStage == 2) {
+            dispatchSporePass(sporeLifecycleShaderProgram, LIFECYCLE_GROUPS_OFFSET);
+        } else {
+            DispatchComputeShader(sporeLifecycleShaderProgram, SPORE_LIFECYCLE_GROUP_SIZE, 1, 1);
+        }
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+    }
+
+    // The passes after it are dispatched with the work group counts the commit wrote
+    glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+    sporePopulationReadback.queueCopy(sporePopulationBuffer, sizeof(SporePopulation));
+
+    // The survivors and the newborns are the spores from now on
+    std::swap(sporesBuffer, sporesBackBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, SPORE_BUFFER_LOCATION, sporesBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, NEXT_SPORES_BUFFER_LOCATION, sporesBackBuffer);
+}
+
+// Without the lifecycle the settings hold the spore count. With it only the GPU knows it, the pass is dispatched
+// with the work group counts the last lifecycle step wrote and the CPU never reads the count back.
+void MoldLabGame::dispatchSporePass(const GLuint program, const GLintptr populationGroupsOffset) const {
+    if (!useSporeLifecycle) {
+        DispatchComputeShader(program, simulationSettings.spore_count, 1, 1);
+        return;
+    }
+
+    glUseProgram(program);
+    glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, sporePopulationBuffer);
+    glDispatchComputeIndirect(populationGroupsOffset);
+    glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, 0);
+}
+
+void MoldLabGame::measureTrailMetrics() {
+    // Created on first use, the snapshot grows with the spore count
+    if (!trailMetricsBuffer || sporeSnapshotCapacity < simulationSettings.spore_count) {
+        initializeTrailMetricsBuffers();
+    }
+
+    // The bounds start empty, the passes only lower the minimum and raise the maximum
+    TrailMetrics reset{};
+    reset.step = simulationStep;
+    std::fill(std::begin(reset.boundsMin), std::end(reset.boundsMin), UINT32_MAX);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, trailMetricsBuffer);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(TrailMetrics), &reset);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    // Motion is only measured against a snapshot of the same spores
+    snapshotAge = snapshotSporeCount == simulationSettings.spore_count ? timeSinceSnapshot : 0.0f;
+
+    metricsTimer.begin();
+    const int gridSize = simulationSettings.grid_size;
+    DispatchComputeShader(trailMetricsShaderProgram, gridSize, gridSize, gridSize);
+
+    // Reads the spores the move pass wrote. The lifecycle moves spores to other indices every step, their motion
+    // can't be followed from one snapshot to the next.
+    if (!useSporeLifecycle) {
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+        glUseProgram(sporeMetricsShaderProgram);
+        snapshotAgeSV.uploadToShader();
+        DispatchComputeShader(sporeMetricsShaderProgram, simulationSettings.spore_count, 1, 1);
+    }
+    metricsTimer.end();
+
+    // The copy reads what the work groups' atomics wrote, it arrives a few frames later
+    glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+    trailMetricsReadback.queueCopy(trailMetricsBuffer, sizeof(TrailMetrics));
+
+    lastMeasuredStep = simulationStep;
+    snapshotSporeCount = useSporeLifecycle ? 0 : simulationSettings.spore_count;
+    timeSinceSnapshot = 0.0f;
+}
+
+// Adds the newest finished readback to the time series, polled every frame so it never waits on the GPU
+void MoldLabGame::collectTrailMetrics() {
+    if (!trailMetricsReadback.readLatest(&latestTrailMetrics)) {
+        return;
+    }
+
+    const TrailMetrics& metrics = latestTrailMetrics;
+    const double gridSize = simulationSettings.grid_size;
+    const double spores = std::max(metrics.sporeCount, 1u);
+
+    TrailMetricsSample sample;
+    sample.step = metrics.step;
+    sample.trailMass = static_cast<double>(joinWords(metrics.massLow, metrics.massHigh)) / TRAIL_MASS_SCALE;
+    sample.occupiedFraction = static_cast<float>(metrics.occupiedVoxels / (gridSize * gridSize * gridSize));
+    std::memcpy(&sample.maxTrail, &metrics.maxTrail, sizeof(float));
+    for (int axis = 0; axis < 3; ++axis) {
+        sample.boundsMin[axis] = metrics.occupiedVoxels > 0 ? static_cast<int>(metrics.boundsMin[axis]) : 0;
+        sample.boundsMax[axis] = metrics.occupiedVoxels > 0 ? static_cast<int>(metrics.boundsMax[axis]) : -1;
+    }
+    sample.meanSporeSpeed = static_cast<float>(static_cast<double>(joinWords(metrics.speedSumLow, metrics.speedSumHigh)) / SPORE_METRIC_SCALE / spores);
+    sample.meanTurnRate = static_cast<float>(static_cast<double>(joinWords(metrics.turnSumLow, metrics.turnSumHigh)) / SPORE_METRIC_SCALE / spores);
+
+    metricsHistory.push_back(sample);
+    if (metricsHistory.size() > MAX_METRICS_SAMPLES) {
+        metricsHistory.pop_front();
+    }
+}
+
+void MoldLabGame::saveTrailMetrics(const std::string& path) const {
+    std::ofstream file(path);
+    if (!file) {
+        std::cerr << "Failed to write " << path << std::endl;
+        return;
+    }
+
+    file << "step,trail_mass,occupied_fraction,max_trail,min_x,min_y,min_z,max_x,max_y,max_z,mean_spore_speed,mean_turn_rate\n";
+    for (const TrailMetricsSample& sample : metricsHistory) {
+        file << sample.step << ',' << sample.trailMass << ',' << sample.occupiedFraction << ',' << sample.maxTrail << ','
+             << sample.boundsMin[0] << ',' << sample.boundsMin[1] << ',' << sample.boundsMin[2] << ','
+             << sample.boundsMax[0] << ',' << sample.boundsMax[1] << ',' << sample.boundsMax[2] << ','
+             << sample.meanSporeSpeed << ',' << sample.meanTurnRate << '\n';
+    }
+}
+
+void MoldLabGame::buildTrailLod() {
+    // Created on first use
+    if (!trailLodTexture) {
+        initializeTrailLodBuffer();
+    }
+
+    glUseProgram(buildTrailLodShaderProgram);
+
+    for (int level = 0; level < TRAIL_LOD_LEVELS; ++level) {
+        if (level > 0) {
+            glBindImageTexture(TRAIL_LOD_READ_LOCATION, trailLodTexture, level - 1, GL_TRUE, 0, GL_READ_ONLY, GL_R16F);
+        }
+        glBindImageTexture(TRAIL_LOD_WRITE_LOCATION, trailLodTexture, level, GL_TRUE, 0, GL_WRITE_ONLY, GL_R16F);
+
+        *lodLevelSV.value = level;
+        lodLevelSV.uploadToShader();
+
+        const int cellSize = 2 << level;
+        const int levelSize = (simulationSettings.grid_size + cellSize - 1) / cellSize;
+        DispatchComputeShader(buildTrailLodShaderProgram, levelSize, levelSize, levelSize);
+        glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+    }
+
+    // Sensing and the renderer sample the chain as a texture
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+    trailLodGeneration = trailGeneration;
+}
+
+void MoldLabGame::bakeDensity() const {
+    glBindImageTexture(BAKED_DENSITY_WRITE_LOCATION, bakedDensityTexture, 0, GL_TRUE, 0, GL_WRITE_ONLY, GL_R16F);
+
+    const int bakedSize = simulationSettings.grid_size + 1;
+    DispatchComputeShader(bakeDensityShaderProgram, bakedSize, bakedSize, bakedSize);
+
+    // The renderer samples the bake as a texture
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+}
+
+GLuint MoldLabGame::executeJFA() const {
+    glUseProgram(jumpFloodInitShaderProgram);
+
+    GLuint readTexture = sdfTexBuffer1;
+    GLuint writeTexture = sdfTexBuffer2; // will be used later
+
+    glBindImageTexture(SDF_TEXTURE_READ_LOCATION, readTexture, 0, GL_TRUE, 0, GL_WRITE_ONLY, GL_RGBA32F); // set it to write ONLY for initialization
+
+
+     int reducedGridSize = simulationSettings.grid_size / simulationSettings.sdf_reduction;
+    DispatchComputeShader(jumpFloodInitShaderProgram, reducedGridSize, reducedGridSize, reducedGridSize);
+    // inits the read, for later use
+    glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+
+
+    glUseProgram(jumpFloodStepShaderProgram);
+
+    // Start with the largest power of 2 that's less than or equal to reducedGridSize
+    int stepSize = 1;
+    while (stepSize * 2 < reducedGridSize) {
+        stepSize *= 2;
+    }
+
+    int iterations = 0;
+    int testStopping = 1;
+
+    while (stepSize >= 1) {
+        iterations++;
+        glBindImageTexture(SDF_TEXTURE_READ_LOCATION, readTexture, 0, GL_TRUE, 0, GL_READ_ONLY, GL_RGBA32F);
+        glBindImageTexture(SDF_TEXTURE_WRITE_LOCATION, writeTexture, 0, GL_TRUE, 0, GL_WRITE_ONLY, GL_RGBA32F);
+
+
+        *jfaStepSV.value = stepSize;
+        jfaStepSV.uploadToShader();
+
+
+        DispatchComputeShader(jumpFloodStepShaderProgram, reducedGridSize, reducedGridSize, reducedGridSize);
+        glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+        stepSize /= 2; // Halve step size
+        std::swap(readTexture, writeTexture);
+
+        if (iterations == testStopping) {
+            // break;
+        }
+    }
+
+    glBindImageTexture(SDF_TEXTURE_READ_LOCATION, readTexture, 0, GL_TRUE, 0, GL_READ_ONLY, GL_RGBA32F);
+    // set to read after last swap for rendering
+
+    return readTexture;
+}
+
+void MoldLabGame::computeCpuSDF() {
+    const int reduction = simulationSettings.sdf_reduction;
+    const int reducedGridSize = simulationSettings.grid_size / reduction;
+
+    // The occupancy bits are 32x smaller than the trail grid, cheap enough to read back every frame
+    occupancyReadback.resize(static_cast<size_t>(OCCUPANCY_BRICKS_X) * OCCUPANCY_BRICKS_Y * OCCUPANCY_BRICKS_Z);
+    glMemoryBarrier(GL_TEXTURE_UPDATE_BARRIER_BIT);
+    glBindTexture(GL_TEXTURE_3D, occupancyTexture);
+    glGetTexImage(GL_TEXTURE_3D, 0, GL_RED_INTEGER, GL_UNSIGNED_INT, occupancyReadback.data());
+    glBindTexture(GL_TEXTURE_3D, 0);
+
+    distanceTransform.seedsFromOccupancy(occupancyReadback, OCCUPANCY_BRICKS_X, OCCUPANCY_BRICKS_Y,
+                                         simulationSettings.grid_size, reduction, sdfSeeds);
+    distanceTransform.compute(sdfSeeds, reducedGridSize, reduction, cpuSdfTexels);
+}
+
+void MoldLabGame::executeCpuSDF() {
+    computeCpuSDF();
+
+    const int reducedGridSize = simulationSettings.grid_size / simulationSettings.sdf_reduction;
+
+    glBindTexture(GL_TEXTURE_3D, sdfTexBuffer1);
+    glTexSubImage3D(GL_TEXTURE_3D, 0, 0, 0, 0, reducedGridSize, reducedGridSize, reducedGridSize, GL_RGBA, GL_FLOAT, cpuSdfTexels.data());
+    glBindTexture(GL_TEXTURE_3D, 0);
+
+    glBindImageTexture(SDF_TEXTURE_READ_LOCATION, sdfTexBuffer1, 0, GL_TRUE, 0, GL_READ_ONLY, GL_RGBA32F);
+}
+
+void MoldLabGame::measureJFAError() {
+    const GLuint jfaTexture = executeJFA();
+
+    // Compare against the texture's real size, it follows the grid size once the resize has been applied
+    GLint sdfTextureSize = 0;
+    glBindTexture(GL_TEXTURE_3D, jfaTexture);
+    glGetTexLevelParameteriv(GL_TEXTURE_3D, 0, GL_TEXTURE_WIDTH, &sdfTextureSize);
+
+    const int reducedGridSize = simulationSettings.grid_size / simulationSettings.sdf_reduction;
+    if (sdfTextureSize != reducedGridSize) {
+        std::cerr << "Warning: SDF texture does not match the current grid size, skipping the JFA error check." << std::endl;
+        glBindTexture(GL_TEXTURE_3D, 0);
+        return;
+    }
+
+    std::vector<float> jfaTexels(static_cast<size_t>(reducedGridSize) * reducedGridSize * reducedGridSize * 4);
+    glMemoryBarrier(GL_TEXTURE_UPDATE_BARRIER_BIT);
+    glGetTexImage(GL_TEXTURE_3D, 0, GL_RGBA, GL_FLOAT, jfaTexels.data());
+    glBindTexture(GL_TEXTURE_3D, 0);
+
+    computeCpuSDF();
+    jfaError = DistanceTransform::compare(cpuSdfTexels, jfaTexels);
+    jfaErrorMeasured = true;
+
+    std::cout << "JFA error against exact EDT: max " << jfaError.maxError << ", mean " << jfaError.meanError
+              << " voxels, " << jfaError.missingSeeds << " cells missing a seed" << std::endl;
+}
+
+
+
+// ============================
+// Core Lifecycle Functions
+// ============================
+void MoldLabGame::renderingStart() {
+    initializeShaders();
+
+    initializeUniformVariables();
+
+    initializeVertexBuffers();
+
+    initializeVoxelGridBuffer();
+
+    initializeOccupancyBuffer();
+
+    initializeTrailPyramidBuffer();
 
     initializeSDFBuffer();
 
@@ -420,17 +1708,450 @@ void MoldLabGame::update(float deltaTime) {
         orbitRadius -= orbitDistanceChange * deltaTime;
     }
 
+    // The ensemble takes the simulation's place while it runs
+    if (useEnsemble) {
+        if (!pauseSimulation) {
+            for (int member = 0; member < ensemble.memberCount(); ++member) {
+                ensemble.setMember(member, ensembleMemberSettings(member));
+            }
+
+            ensembleTimer.begin();
+            ensemble.step(deltaTime);
+            ensembleTimer.end();
+            bindSimulationResources();
+        }
+        return;
+    }
+
     DispatchComputeShaders();
+
+    if (useTrailMetrics) {
+        collectTrailMetrics();
+    }
 }
 
 
 void MoldLabGame::render() {
-    // While using the
-    glUseProgram(shaderProgram);
+    const int width = getScreenWidth();
+    const int height = getScreenHeight();
+    if (width < 1 || height < 1) {
+        return; // Minimized
+    }
+
+    // Cubes are rasterized with depth testing straight into the window
+    if (renderMode == RenderMode::Instanced) {
+        renderTimer.begin();
+        renderVoxelInstances();
+        renderTimer.end();
+        return;
+    }
+
+    // Rebuilt when the trail changed, then drawn straight into the window. The ensemble is only shown this way.
+    if (useEnsemble || renderMode == RenderMode::Projection || renderMode == RenderMode::Slice) {
+        renderTimer.begin();
+        renderProjection(width, height);
+        renderTimer.end();
+        return;
+    }
+
+    // The ray marchers render into the offscreen target, which is then upscaled to the window
+    int renderWidth = std::max(1, static_cast<int>(std::lround(static_cast<float>(width) * renderScale)));
+    int renderHeight = std::max(1, static_cast<int>(std::lround(static_cast<float>(height) * renderScale)));
+    FrameInputs frameInputs = currentFrameInputs(renderWidth, renderHeight);
+    const bool unchanged = reuseIdleFrames && frameInputs == lastFrameInputs;
+    // A checkerboarded image still holds reconstructed pixels, it is marched in full once before being reused
+    const bool idle = unchanged && !lastFrameCheckerboarded;
+
+    // The scale holds still while idle, the timer has nothing new and a change would restart refinement
+    if (useAutoRenderScale && !idle) {
+        updateRenderScale();
+        renderWidth = std::max(1, static_cast<int>(std::lround(static_cast<float>(width) * renderScale)));
+        renderHeight = std::max(1, static_cast<int>(std::lround(static_cast<float>(height) * renderScale)));
+        frameInputs = currentFrameInputs(renderWidth, renderHeight);
+    }
+
+    // Idle frames either show the last image again or add one more jittered sample to it
+    const bool accumulate = reuseIdleFrames && useProgressiveRefinement && renderMode != RenderMode::Software;
+    if (idle && (!accumulate || accumulatedSamples >= MAX_ACCUMULATED_SAMPLES)) {
+        presentRenderTarget(width, height);
+        return;
+    }
+
+    if (!idle) {
+        accumulatedSamples = 0;
+    }
+
+    // The first sample goes through the pixel centers, the rest spread over the pixel
+    pixelJitter[0] = accumulatedSamples > 0 ? (haltonSequence(accumulatedSamples, 2) - 0.5f) * 2.0f / static_cast<float>(renderWidth) : 0.0f;
+    pixelJitter[1] = accumulatedSamples > 0 ? (haltonSequence(accumulatedSamples, 3) - 0.5f) * 2.0f / static_cast<float>(renderHeight) : 0.0f;
+
+    if (renderWidth != renderTextureWidth || renderHeight != renderTextureHeight) {
+        initializeRenderTarget(renderWidth, renderHeight);
+    }
+
+    // Checkerboarding only pays off while the image changes, the full march finishing it counts as unchanged
+    const bool checkerboardTargets = useCheckerboard && (renderMode == RenderMode::Fragment || renderMode == RenderMode::Compute);
+    const bool checkerboard = checkerboardTargets && !unchanged;
+    if (checkerboardTargets) {
+        if (renderWidth != checkerboardTargetWidth || renderHeight != checkerboardTargetHeight) {
+            initializeCheckerboardTargets(renderWidth, renderHeight);
+        }
+        glBindImageTexture(CHECKERBOARD_DEPTH_LOCATION, checkerboardDepthTexture, 0, GL_FALSE, 0, GL_READ_WRITE, GL_R32F);
+
+        checkerboardPhase = (checkerboardPhase + 1) % 4;
+        checkerboardFrame = checkerboard ? checkerboardPhase : -1;
+    }
+
+    const bool marchStatistics = useMarchStatistics && (renderMode == RenderMode::Fragment || renderMode == RenderMode::Compute);
+    if (marchStatistics) {
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, marchStatisticsBuffer);
+        glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    }
+
+    renderTimer.begin();
+
+    if (useDepthPrepass && (renderMode == RenderMode::Fragment || renderMode == RenderMode::Compute)) {
+        renderDepthPrepass(renderWidth, renderHeight);
+    }
+
+    if (renderMode == RenderMode::Compute) {
+        renderCompute(renderWidth, renderHeight);
+        if (marchStatistics) {
+            readBackMarchStatistics();
+        }
+    } else if (renderMode == RenderMode::Software) {
+        renderSoftware(renderWidth, renderHeight);
+    } else {
+        // At full resolution with nothing to keep, the quad goes straight to the window, skipping the copy
+        const bool direct = renderWidth == width && renderHeight == height && !reuseIdleFrames && !checkerboardTargets;
+        if (!direct) {
+            glBindFramebuffer(GL_DRAW_FRAMEBUFFER, renderFramebuffer);
+            glViewport(0, 0, renderWidth, renderHeight);
+        }
+
+        glUseProgram(shaderProgram);
+        pixelJitterSV.uploadToShader();
+        if (useCheckerboard) {
+            checkerboardFrameSV.uploadToShader();
+        }
+        if (useTrailLod && useTransparency) {
+            trailLodDistanceSV.uploadToShader();
+        }
+
+        // Draw the full-screen quad
+        glBindVertexArray(triangleVao);
+        glDrawArrays(GL_TRIANGLES, 0, 6);
+
+        if (marchStatistics) {
+            readBackMarchStatistics();
+        }
+
+        if (direct) {
+            lastFrameInputs = FrameInputs{}; // The render target does not hold this frame
+            renderTimer.end();
+            return;
+        }
+
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+        glViewport(0, 0, width, height);
+    }
+
+    if (checkerboard) {
+        resolveCheckerboard(renderWidth, renderHeight);
+    }
+
+    if (accumulate) {
+        accumulateFrame(renderWidth, renderHeight);
+        glViewport(0, 0, width, height);
+    }
+
+    // The next checkerboarded frame reprojects this one
+    if (checkerboardTargets) {
+        glCopyImageSubData(renderTexture, GL_TEXTURE_2D, 0, 0, 0, 0,
+                           checkerboardHistoryTexture, GL_TEXTURE_2D, 0, 0, 0, 0, renderWidth, renderHeight, 1);
+    }
+
+    renderTimer.end();
+
+    lastFrameCheckerboarded = checkerboard;
+    lastFrameInputs = frameInputs;
+    presentRenderTarget(width, height);
+}
+
+FrameInputs MoldLabGame::currentFrameInputs(const int width, const int height) const {
+    FrameInputs inputs;
+    inputs.derived = {trailGeneration, renderShaderGeneration, renderMode, useCpuSdf};
+    std::copy(simulationSettings.camera_position, simulationSettings.camera_position + 3, inputs.camera);
+    std::copy(simulationSettings.camera_focus, simulationSettings.camera_focus + 3, inputs.camera + 3);
+    inputs.width = width;
+    inputs.height = height;
+    return inputs;
+}
+
+void MoldLabGame::accumulateFrame(const int width, const int height) {
+    // Running mean, sample n goes in with weight 1 / (n + 1) so the first one replaces the old average
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, accumulationFramebuffer);
+    glViewport(0, 0, width, height);
+
+    glEnable(GL_BLEND);
+    glBlendColor(0.0f, 0.0f, 0.0f, 1.0f / static_cast<float>(accumulatedSamples + 1));
+    glBlendFunc(GL_CONSTANT_ALPHA, GL_ONE_MINUS_CONSTANT_ALPHA);
+
+    // At the same size the upscale lands every texel on its own pixel, a plain copy
+    glUseProgram(upscaleShaderProgram);
+    glBindVertexArray(triangleVao);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+
+    glDisable(GL_BLEND);
+
+    // Back into the render target, which is what gets presented and reused
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, accumulationFramebuffer);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, renderFramebuffer);
+    glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+
+    ++accumulatedSamples;
+}
+
+void MoldLabGame::presentRenderTarget(const int width, const int height) {
+    const bool scaled = renderTextureWidth != width || renderTextureHeight != height;
+
+    if (scaled && useEdgeAwareUpscale) {
+        glUseProgram(upscaleShaderProgram);
+        glBindVertexArray(triangleVao);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        return;
+    }
+
+    // Bilinear when scaling up, a plain copy otherwise
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, renderFramebuffer);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    glBlitFramebuffer(0, 0, renderTextureWidth, renderTextureHeight, 0, 0, width, height, GL_COLOR_BUFFER_BIT, scaled ? GL_LINEAR : GL_NEAREST);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+}
+
+void MoldLabGame::updateRenderScale() {
+    const float renderMilliseconds = renderTimer.latestMilliseconds();
+    if (renderMilliseconds <= 0.0f) {
+        return; // No measurement yet
+    }
+
+    const float ratio = targetRenderMilliseconds / renderMilliseconds;
+    if (std::abs(ratio - 1.0f) < RENDER_SCALE_TOLERANCE) {
+        return;
+    }
+
+    // Marching cost follows the pixel count, the square of the scale
+    const float correction = std::pow(ratio, 0.5f * RENDER_SCALE_GAIN);
+    renderScale = std::clamp(renderScale * correction, MIN_RENDER_SCALE, MAX_RENDER_SCALE);
+}
+
+void MoldLabGame::renderDepthPrepass(const int width, const int height) {
+    const int tilesX = (width + DEPTH_PREPASS_TILE_SIZE - 1) / DEPTH_PREPASS_TILE_SIZE;
+    const int tilesY = (height + DEPTH_PREPASS_TILE_SIZE - 1) / DEPTH_PREPASS_TILE_SIZE;
+    if (tilesX != depthPrepassWidth || tilesY != depthPrepassHeight) {
+        initializeDepthPrepassTarget(tilesX, tilesY);
+    }
+
+    glUseProgram(depthPrepassShaderProgram);
+    depthPrepassScreenSize[0] = static_cast<float>(width);
+    depthPrepassScreenSize[1] = static_cast<float>(height);
+    depthPrepassScreenSizeSV.uploadToShader();
+
+    // Written here, read by whichever renderer runs next
+    glBindImageTexture(DEPTH_PREPASS_LOCATION, depthPrepassTexture, 0, GL_FALSE, 0, GL_READ_WRITE, GL_R32F);
+    DispatchComputeShader(depthPrepassShaderProgram, tilesX, tilesY, 1);
+    glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+}
+
+void MoldLabGame::readBackMarchStatistics() {
+    // The copy reads what the marchers' atomics wrote
+    glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+    marchStatisticsReadback.queueCopy(marchStatisticsBuffer, sizeof(MarchStatistics));
+}
+
+void MoldLabGame::resolveCheckerboard(const int width, const int height) {
+    glUseProgram(checkerboardResolveShaderProgram);
+    resolveCheckerboardFrameSV.uploadToShader();
+
+    // The history is last frame's render target, it only lines up with the same size and look
+    const FrameInputs& previous = lastFrameInputs;
+    checkerboardHistoryValid = previous.width == width && previous.height == height &&
+                               previous.derived.renderShaderGeneration == renderShaderGeneration &&
+                               previous.derived.renderMode == renderMode;
+    std::copy(previous.camera, previous.camera + 3, previousCameraPosition);
+    std::copy(previous.camera + 3, previous.camera + 6, previousCameraFocus);
+    checkerboardHistoryValidSV.uploadToShader();
+    previousCameraPositionSV.uploadToShader();
+    previousCameraFocusSV.uploadToShader();
+
+    // The marchers wrote colours through the framebuffer or image stores and depths through image stores
+    glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
+    glBindImageTexture(RENDER_TARGET_LOCATION, renderTexture, 0, GL_FALSE, 0, GL_READ_WRITE, GL_RGBA8);
+    DispatchComputeShader(checkerboardResolveShaderProgram, width, height, 1);
+
+    glMemoryBarrier(GL_FRAMEBUFFER_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT | GL_TEXTURE_UPDATE_BARRIER_BIT);
+}
+
+void MoldLabGame::renderCompute(const int width, const int height) {
+    glUseProgram(renderComputeShaderProgram);
+    computePixelJitterSV.uploadToShader();
+    if (useCheckerboard) {
+        computeCheckerboardFrameSV.uploadToShader();
+    }
+    if (useTrailLod && useTransparency) {
+        computeTrailLodDistanceSV.uploadToShader();
+    }
+
+    glBindImageTexture(RENDER_TARGET_LOCATION, renderTexture, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA8);
+    DispatchComputeShader(renderComputeShaderProgram, width, height, 1);
+
+    // Presented by a blit or the upscale shader's texture fetches
+    glMemoryBarrier(GL_FRAMEBUFFER_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
+}
+
+void MoldLabGame::renderProjection(const int width, const int height) {
+    const ProjectionKind kind = renderMode == RenderMode::Slice ? ProjectionKind::Slice : projectionKind;
+
+    GLuint projectionTexture;
+    if (useEnsemble) {
+        // Looking along z puts the members' tiles side by side
+        ensemble.bind();
+        ensembleProjection.project(ensemble.atlasSize(), ProjectionSettings{2, kind, projectionSlice}, ensemble.generation());
+        projectionTexture = ensembleProjection.texture();
+        bindSimulationResources();
+    } else {
+        trailProjection.project(simulationSettings.grid_size, ProjectionSettings{projectionAxis, kind, projectionSlice}, trailGeneration);
+        projectionTexture = trailProjection.texture();
+    }
+
+    glActiveTexture(GL_TEXTURE0 + PROJECTION_TEXTURE_UNIT);
+    glBindTexture(GL_TEXTURE_2D, projectionTexture);
+    glActiveTexture(GL_TEXTURE0);
+
+    // The square image fills the shorter side of the window
+    const float side = static_cast<float>(std::min(width, height));
+    projectionViewScale[0] = side / static_cast<float>(width);
+    projectionViewScale[1] = side / static_cast<float>(height);
+
+    glUseProgram(projectionViewShaderProgram);
+    projectionExposureSV.uploadToShader();
+    projectionViewScaleSV.uploadToShader();
 
-    // Draw the full-screen quad
     glBindVertexArray(triangleVao);
-    glDrawArrays(GL_TRIANGLES, 0, 6);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+}
+
+void MoldLabGame::updateVoxelViewProjection() {
+    vec3 eye = {simulationSettings.camera_position[0], simulationSettings.camera_position[1], simulationSettings.camera_position[2]};
+    vec3 center = {simulationSettings.camera_focus[0], simulationSettings.camera_focus[1], simulationSettings.camera_focus[2]};
+    vec3 up = {0.0f, 1.0f, 0.0f};
+
+    mat4x4 view;
+    mat4x4_look_at(view, eye, center, up);
+
+    // camera_ray spans [-1, 1] on y at unit distance (90 degrees) and scales x by the aspect ratio
+    vec3 toCenter;
+    vec3_sub(toCenter, center, eye);
+    const float farPlane = vec3_len(toCenter) + static_cast<float>(simulationSettings.grid_size) * 2.0f;
+    mat4x4 projection;
+    mat4x4_perspective(projection, static_cast<float>(M_PI) / 2.0f, simulationSettings.aspect_ratio, 0.5f, farPlane);
+
+    // Its right vector is up x forward, the mirror image of look_at's
+    mat4x4 mirror;
+    mat4x4_identity(mirror);
+    mirror[0][0] = -1.0f;
+
+    mat4x4 mirroredProjection;
+    mat4x4_mul(mirroredProjection, mirror, projection);
+    mat4x4_mul(voxelViewProjection, mirroredProjection, view);
+
+    vec3_dup(voxelCameraPosition, eye);
+    voxelCameraCutoutRadius = static_cast<float>(simulationSettings.grid_size) / 4.0f;
+}
+
+void MoldLabGame::renderVoxelInstances() {
+    // Only allocated once the mode is used, the instance buffer is large
+    if (!voxelInstanceBuffer) {
+        initializeVoxelInstanceBuffers();
+    }
+
+    // The compaction counts its instances into the command, the CPU only ever resets it
+    const VoxelDrawCommand resetCommand{VOXEL_CUBE_VERTICES, 0, 0, 0};
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, voxelDrawBuffer);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(resetCommand), &resetCommand);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    glUseProgram(compactVoxelsShaderProgram);
+    voxelThresholdSV.uploadToShader();
+
+    const int gridSize = simulationSettings.grid_size;
+    DispatchComputeShader(compactVoxelsShaderProgram, gridSize, gridSize, gridSize);
+    glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
+
+    updateVoxelViewProjection();
+    glUseProgram(voxelInstancesShaderProgram);
+    voxelViewProjectionSV.uploadToShader();
+    voxelCameraPositionSV.uploadToShader();
+    voxelCameraCutoutRadiusSV.uploadToShader();
+
+    glEnable(GL_DEPTH_TEST);
+    glClear(GL_DEPTH_BUFFER_BIT);
+
+    glBindVertexArray(voxelInstanceVao);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, voxelDrawBuffer);
+    glDrawArraysIndirect(GL_TRIANGLES, nullptr);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    glBindVertexArray(0);
+
+    glDisable(GL_DEPTH_TEST);
+}
+
+void MoldLabGame::readBackTrail() {
+    const int gridSize = simulationSettings.grid_size;
+    const size_t sliceSize = static_cast<size_t>(gridSize) * gridSize;
+    trailReadback.resize(sliceSize * gridSize);
+
+    // The texture is allocated at the largest grid size, so read the live region slice by slice rather than all of it
+    if (!trailReadFramebuffer) {
+        glGenFramebuffers(1, &trailReadFramebuffer);
+    }
+
+    glMemoryBarrier(GL_FRAMEBUFFER_BARRIER_BIT);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, trailReadFramebuffer);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    for (int z = 0; z < gridSize; ++z) {
+        glFramebufferTextureLayer(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, voxelGridTexture, 0, z);
+        glReadPixels(0, 0, gridSize, gridSize, GL_RED, GL_FLOAT, &trailReadback[sliceSize * z]);
+    }
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+}
+
+void MoldLabGame::renderSoftware(const int width, const int height) {
+    readBackTrail();
+
+    // The CPU SDF path already read back the occupancy and built the field this frame
+    if (!useCpuSdf) {
+        computeCpuSDF();
+    }
+
+    SoftwareScene scene;
+    scene.trail = trailReadback.data();
+    scene.sdfTexels = cpuSdfTexels.data();
+    scene.occupancyWords = occupancyReadback.data();
+    scene.brickCountX = OCCUPANCY_BRICKS_X;
+    scene.brickCountY = OCCUPANCY_BRICKS_Y;
+    scene.brickCountZ = OCCUPANCY_BRICKS_Z;
+    scene.settings = simulationSettings;
+
+    softwareRenderer.render(scene, width, height, useTransparency, softwareFrame);
+
+    glBindTexture(GL_TEXTURE_2D, renderTexture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, softwareFrame.data());
+    glBindTexture(GL_TEXTURE_2D, 0);
 }
 
 bool SliderFloatWithTooltip(const char* label, const char* sliderId, float* value, float min, float max, const char* tooltip) {
@@ -450,9 +2171,14 @@ bool SliderFloatWithTooltip(const char* label, const char* sliderId, float* valu
     return valueChanged;
 }
 
-bool SliderIntWithTooltip(const char* label, const char* sliderId, int* value, int min, int max, const char* tooltip) {
+bool SliderIntWithTooltip(const char* label, const char* sliderId, int* value, int min, int max, const char* tooltip,
+                          bool* editFinished = nullptr) {
     // Display the slider with the provided ID
     bool valueChanged = ImGui::SliderInt(sliderId, value, min, max);
+    // Released after changing the value, for settings too costly to apply on every step of a drag
+    if (editFinished) {
+        *editFinished = ImGui::IsItemDeactivatedAfterEdit();
+    }
 
     // Place the slider on the same line
     ImGui::SameLine();
@@ -498,16 +2224,20 @@ void MoldLabGame::renderUI() {
 
     SliderIntWithTooltip("Spore Count", "##SporeCountSlider", &simulationSettings.spore_count, 1, SimulationDefaults::MAX_SPORE_COUNT, "Number of spores in the simulation.");
 
-    int previousGridSize = simulationSettings.grid_size;
-    gridSizeChanged = SliderIntWithTooltip("Grid Size", "##GridSizeSlider", &simulationSettings.grid_size, 25,
-                         SimulationDefaults::MAX_GRID_SIZE,
+    // Every resize resamples the trail from the one before, a drag is applied once on release by its total factor
+    bool gridSizeReleased = false;
+    SliderIntWithTooltip("Grid Size", "##GridSizeSlider", &gridSizeSlider, 25, SimulationDefaults::MAX_GRID_SIZE,
                          "The number of voxels that make up one side length of the cube grid. "
-                         "\nNote: This will Clear the current voxels and randomize spore positions. Will also scale grid-size dependent settings with it");
+                         "\nNote: Once released the current voxels are resampled and the spores moved to the new size, the run carries on. Will also scale grid-size dependent settings with it",
+                         &gridSizeReleased);
+
+    if (gridSizeReleased) {
+        int previousGridSize = simulationSettings.grid_size;
 
-    if (gridSizeChanged) {
         // Ensure grid_size is divisible by sdf_reduction
         int reduction = simulationSettings.sdf_reduction;
-        simulationSettings.grid_size = (simulationSettings.grid_size / reduction) * reduction;
+        simulationSettings.grid_size = (gridSizeSlider / reduction) * reduction;
+        gridSizeSlider = simulationSettings.grid_size;
 
         if (previousGridSize != simulationSettings.grid_size) {
             float gridResizeFactor = static_cast<float>(simulationSettings.grid_size) / static_cast<float>(previousGridSize);
@@ -515,8 +2245,6 @@ void MoldLabGame::renderUI() {
             simulationSettings.sensor_distance *= gridResizeFactor;
 
             orbitRadius *= gridResizeFactor;
-
-            simulationSettings.grid_resize_factor = gridResizeFactor;
         }
     }
 
@@ -530,17 +2258,43 @@ void MoldLabGame::renderUI() {
     SliderFloatWithTooltip("Sensor Distance", "##SensorDistanceSlider", &simulationSettings.sensor_distance, 0.0f, static_cast<float>(simulationSettings.grid_size) / 2.0f, "Sets the distance that the spore can see. In Voxels.");
     SliderFloatWithTooltip("Sensor Angle", "##SensorAngleSlider", &simulationSettings.sensor_angle, 0.0f, M_PI, "Sets the angle that the spores see. In Radians. 0 is directly on the forward sensor, PI being directly behind it.");
 
+    if (ImGui::Checkbox("Diffusion", &useDiffusion)) {
+        setShaderVariant(DIFFUSION_DEFINITION, useDiffusion);
+        initializeDecayShaders();
+    }
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("%s", "Spreads the trail into the neighbouring voxels every step before it decays, a separable blur along each axis.");
+    }
+
+    if (useDiffusion) {
+        SliderFloatWithTooltip("Diffusion Rate", "##DiffusionRateSlider", &simulationSettings.diffusion_rate, 0.0f, 60.0f, "How fast the trail spreads, per second. Every axis spreads up to a third of a voxel's trail to each side per step.");
+    }
+
     ImGui::Spacing();
     ImGui::Separator();
 
     if (ImGui::Button("Randomize Spores")) {
-        resetSporesAndGrid(); // Call the function when the button is pressed
+        if (useEnsemble) {
+            ensemble.reset();
+            bindSimulationResources();
+        } else {
+            if (useSporeLifecycle) {
+                resetSporePopulation();
+            }
+            resetSporesAndGrid(); // Call the function when the button is pressed
+            ++trailGeneration;
+        }
     }
 
     if (ImGui::IsItemHovered()) {
         ImGui::SetTooltip("%s", "Randomizes Spore positions and resets Grid Values"); // Show tooltip if provided
     }
 
+    ImGui::InputInt("Seed", &simulationSettings.seed);
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("%s", "Spores start from the same positions for the same seed, on any GPU. Applied the next time they are randomized.");
+    }
+
 
     bool previousTransparentState = useTransparency; // Track the previous state
     if (ImGui::Checkbox("Use Transparency", &useTransparency)) {
@@ -550,14 +2304,386 @@ void MoldLabGame::renderUI() {
     }
 
 
+    const char* renderModeNames[] = {"Fragment", "Compute Tiles", "Instanced Cubes", "Software (CPU)", "Projection", "Slice"};
+    int renderModeIndex = static_cast<int>(renderMode);
+    if (ImGui::Combo("Renderer", &renderModeIndex, renderModeNames, IM_ARRAYSIZE(renderModeNames))) {
+        renderMode = static_cast<RenderMode>(renderModeIndex);
+    }
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("%s", "Fragment marches every pixel of a full-screen quad. Compute Tiles marches 8x8 tiles in a compute shader, rejecting tiles that miss the grid or only cross empty space. "
+                                "Instanced Cubes rasterizes the voxels above the threshold, cheaper than ray marching while the grid is sparse. "
+                                "Software (CPU) reads the grid back and ray marches it on the CPU threads. "
+                                "Projection and Slice flatten the grid along an axis once per simulation step, cheap views for monitoring long runs.");
+    }
+
+    if (renderMode == RenderMode::Projection || renderMode == RenderMode::Slice) {
+        const char* axisNames[] = {"X", "Y", "Z"};
+        ImGui::Combo("View Axis", &projectionAxis, axisNames, IM_ARRAYSIZE(axisNames));
+
+        if (renderMode == RenderMode::Projection) {
+            const char* projectionKindNames[] = {"Maximum", "Average"};
+            int projectionKindIndex = static_cast<int>(projectionKind);
+            if (ImGui::Combo("Projection", &projectionKindIndex, projectionKindNames, IM_ARRAYSIZE(projectionKindNames))) {
+                projectionKind = static_cast<ProjectionKind>(projectionKindIndex);
+            }
+            if (ImGui::IsItemHovered()) {
+                ImGui::SetTooltip("%s", "Maximum shows the brightest voxel along each line of sight, Average the mean trail along it.");
+            }
+        } else {
+            ImGui::SliderInt("Slice", &projectionSlice, 0, simulationSettings.grid_size - 1);
+        }
+
+        SliderFloatWithTooltip("Exposure", "##ProjectionExposureSlider", &projectionExposure, 0.1f, 20.0f, "Multiplies the trail values before they are coloured, raise it for faint averages.");
+
+        if (ImGui::Button("Save Thumbnail")) {
+            trailProjection.saveThumbnail("trail_thumbnail.ppm", PROJECTION_THUMBNAIL_SIZE, projectionExposure);
+        }
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("%s", "Writes the current view, at most 256 pixels a side, to trail_thumbnail.ppm.");
+        }
+    }
+
+    if (renderMode == RenderMode::Instanced) {
+        SliderFloatWithTooltip("Voxel Threshold", "##VoxelThresholdSlider", &voxelThreshold, 0.0f, 1.0f, "Voxels with less trail than this are not drawn. Raising it thins out dense grids.");
+    }
+
+    if (renderMode == RenderMode::Software) {
+        if (ImGui::Button("Save Frame") && !softwareFrame.empty()) {
+            ImageIO::savePPM("software_frame.ppm", renderTextureWidth, renderTextureHeight, softwareFrame);
+        }
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("%s", "Writes the last software rendered frame to software_frame.ppm.");
+        }
+    }
+
+
+    ImGui::Checkbox("Pause Simulation", &pauseSimulation);
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("%s", "Stops moving spores and decaying the trail, the camera can still orbit the frozen grid.");
+    }
+
+    // Only the ray marchers render offscreen
+    if (renderMode == RenderMode::Fragment || renderMode == RenderMode::Compute || renderMode == RenderMode::Software) {
+        ImGui::Checkbox("Reuse Idle Frames", &reuseIdleFrames);
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("%s", "Shows the last image again while the camera, the trail and the render settings are unchanged instead of ray marching it again.");
+        }
+
+        if (reuseIdleFrames) {
+            ImGui::Checkbox("Progressive Refinement", &useProgressiveRefinement);
+            if (ImGui::IsItemHovered()) {
+                ImGui::SetTooltip("%s", "Spends idle frames averaging jittered samples into the image for smoother edges, up to 64 per pixel.");
+            }
+            if (useProgressiveRefinement) {
+                ImGui::SameLine();
+                ImGui::Text("%d samples", accumulatedSamples);
+            }
+        }
+
+        SliderFloatWithTooltip("Render Scale", "##RenderScaleSlider", &renderScale, MIN_RENDER_SCALE, MAX_RENDER_SCALE, "Fraction of the window resolution the grid is ray marched at before being upscaled to the window.");
+
+        ImGui::Checkbox("Auto Scale", &useAutoRenderScale);
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("%s", "Adjusts the render scale every frame to hold the target render time.");
+        }
+        if (useAutoRenderScale) {
+            SliderFloatWithTooltip("Target ms", "##TargetRenderTimeSlider", &targetRenderMilliseconds, 2.0f, 50.0f, "GPU time the render pass should take, the scale follows it.");
+        }
+
+        ImGui::Checkbox("Edge-Aware Upscale", &useEdgeAwareUpscale);
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("%s", "Upscales without blending across sharp colour edges instead of plain bilinear filtering.");
+        }
+
+        if (renderMode == RenderMode::Fragment || renderMode == RenderMode::Compute) {
+            if (ImGui::Checkbox("Checkerboard", &useCheckerboard)) {
+                setShaderVariant(CHECKERBOARD_DEFINITION, useCheckerboard);
+                initializeRenderShader(useTransparency);
+            }
+            if (ImGui::IsItemHovered()) {
+                ImGui::SetTooltip("%s", "While the image changes, ray marches half the pixels each frame in a rotating pattern and fills in the rest from their neighbours and the previous frame moved along with the camera.");
+            }
+
+            if (useCheckerboard) {
+                ImGui::SameLine();
+                if (ImGui::Checkbox("Quarter", &useQuarterCheckerboard)) {
+                    setShaderVariant(QUARTER_CHECKERBOARD_DEFINITION, useQuarterCheckerboard);
+                    initializeRenderShader(useTransparency);
+                }
+                if (ImGui::IsItemHovered()) {
+                    ImGui::SetTooltip("%s", "Marches one pixel of every 2x2 block per frame instead of half of them, cheaper but blurrier in motion.");
+                }
+            }
+        }
+    }
+
+
+    if (ImGui::Checkbox("Pyramid Skipping", &usePyramidSkipping)) {
+        setShaderVariant(PYRAMID_SKIPPING_DEFINITION, usePyramidSkipping);
+        initializeRenderShader(useTransparency);
+    }
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("%s", "Skips empty space with a min/max pyramid of the trail grid before falling back to the SDF.");
+    }
+
+
+    if (ImGui::Checkbox("Depth Prepass", &useDepthPrepass)) {
+        setShaderVariant(DEPTH_PREPASS_DEFINITION, useDepthPrepass);
+        initializeRenderShader(useTransparency);
+    }
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("%s", "Cone marches one ray per 8x8 pixel tile first, every pixel of the tile then starts at the distance it found empty.");
+    }
+
+
+    if (ImGui::Checkbox("Baked Density", &useBakedDensity)) {
+        // Only allocated once asked for, it is as large as the trail grid at half the precision
+        if (useBakedDensity && !bakedDensityTexture) {
+            initializeBakedDensityBuffer();
+        }
+        setShaderVariant(BAKED_DENSITY_DEFINITION, useBakedDensity);
+        initializeRenderShader(useTransparency);
+    }
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("%s", "Bakes the smoothed voxel surface into a texture once per frame, the opaque renderer then takes one filtered fetch per step instead of blending 27 cubes.");
+    }
+
+    if (ImGui::Checkbox("LOD Rendering", &useTrailLod)) {
+        setShaderVariant(USE_TRAIL_LOD_DEFINITION, useTrailLod);
+        initializeRenderShader(useTransparency);
+    }
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("%s", "Past the LOD distance from the camera the transparent renderer steps through cells of a mean trail mip chain instead of single voxels, a level coarser every time the distance doubles.");
+    }
+
+    if (useTrailLod && useTransparency) {
+        const auto gridSize = static_cast<float>(simulationSettings.grid_size);
+        if (SliderFloatWithTooltip("LOD Distance", "##TrailLodDistanceSlider", &trailLodDistance, gridSize * 0.25f, gridSize * 4.0f, "Distance from the camera in voxels where rays switch to 2x2x2 cells.")) {
+            lastFrameInputs = FrameInputs{}; // The reused frame was marched with the old distance
+        }
+    }
+
+
+    if (ImGui::Checkbox("Trail Sampler", &useTrailSampler)) {
+        setShaderVariant(TRAIL_SAMPLER_DEFINITION, useTrailSampler);
+        initializeRenderShader(useTransparency);
+        initializeMoveSporesShader(wrapGrid);
+    }
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("%s", "Reads the trail grid through a sampler (texture cache) instead of image loads when sensing and rendering.");
+    }
+
+    if (ImGui::Checkbox("Trilinear Sensing", &useTrilinearSensing)) {
+        setShaderVariant(TRILINEAR_SENSING_DEFINITION, useTrilinearSensing);
+        initializeMoveSporesShader(wrapGrid);
+    }
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("%s", "Spores sense the trail blended between the eight nearest voxels instead of the one they point into, for smoother turning.");
+    }
+
+    if (ImGui::Checkbox("LOD Sensing", &useLodSensing)) {
+        setShaderVariant(LOD_SENSING_DEFINITION, useLodSensing);
+        initializeMoveSporesShader(wrapGrid);
+    }
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("%s", "Sensors reaching further than 16 voxels read the mean trail of a cell that grows with the sensor distance, from a mip chain rebuilt every step, instead of a single distant voxel.");
+    }
+
+    // A few frames late, toggle the options above to compare the paths
+    ImGui::Text("Decay: %.2f ms, Sensing: %.2f ms, Deposit: %.2f ms, Rendering: %.2f ms", decayTimer.latestMilliseconds(),
+                moveSporesTimer.latestMilliseconds(), depositTimer.latestMilliseconds(), renderTimer.latestMilliseconds());
+
+    ImGui::Checkbox("Binned Deposit", &useBinnedDeposit);
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("%s", "Spores add trail instead of marking their voxel full. Each work group sums the spores sharing a voxel in shared memory, then updates every distinct voxel once with a global atomic.");
+    }
+
+    if (useBinnedDeposit) {
+        SliderFloatWithTooltip("Deposit Amount", "##DepositAmountSlider", &depositAmount, 0.0f, 1.0f, "Trail one spore adds to its voxel per step, voxels saturate at 1. At 1 it matches marking the voxel full.");
+
+        depositStatisticsReadback.readLatest(&latestDepositStatistics);
+
+        // Merges are atomics the bins saved, conflicts are the global ones that had to be retried
+        const DepositStatistics& statistics = latestDepositStatistics;
+        ImGui::Text("Merged: %.1f%% of deposits, Conflicts: %.2f%% of atomics",
+                    100.0 * statistics.binMerges / std::max(statistics.deposits, 1u),
+                    100.0 * statistics.atomicConflicts / std::max(statistics.globalAtomics, 1u));
+    }
+
+    ImGui::BeginDisabled(!sporeLifecycleSupported);
+    const bool sporeLifecycleToggled = ImGui::Checkbox("Spore Lifecycle", &useSporeLifecycle);
+    ImGui::EndDisabled();
+    if (sporeLifecycleToggled) {
+        setShaderVariant(SPORE_LIFECYCLE_DEFINITION, useSporeLifecycle);
+        initializeSporePassShaders();
+        initializeMoveSporesShader(wrapGrid);
+
+        // Starts from the spores there are, turned off it carries on with the ones alive
+        if (useSporeLifecycle) {
+            resetSporePopulation();
+        } else {
+            adoptLiveSporeCount();
+        }
+        snapshotSporeCount = 0;
+    }
+    if (ImGui::IsItemHovered(ImGuiHoveredFlags_AllowWhenDisabled)) {
+        ImGui::SetTooltip("%s", sporeLifecycleSupported
+            ? "Spores die in crowded voxels and split where the trail is moderate. The survivors are compacted on the GPU every step and the spore passes are sized from the live count there, without waiting on a readback."
+            : "Needs more shader storage buffer bindings than this driver offers.");
+    }
+
+    if (useSporeLifecycle) {
+        SliderFloatWithTooltip("Crowding Trail", "##CrowdingTrailSlider", &crowdingTrail, 0.0f, 1.0f, "Trail from which a voxel counts as crowded, spores in it die.");
+        SliderFloatWithTooltip("Death Rate", "##DeathRateSlider", &sporeDeathRate, 0.0f, 5.0f, "Chance per second that a spore in a crowded voxel dies.");
+        SliderFloatWithTooltip("Spawn Trail", "##SpawnTrailSlider", &spawnTrail, 0.0f, 1.0f, "Trail from which spores split in two, up to a crowded voxel. The child starts at its parent's position with a random heading.");
+        SliderFloatWithTooltip("Spawn Rate", "##SpawnRateSlider", &sporeSpawnRate, 0.0f, 5.0f, "Chance per second that a spore in a voxel with enough trail splits.");
+
+        // A few frames old, the passes never wait for it
+        sporePopulationReadback.readLatest(&latestSporePopulation);
+        ImGui::Text("Live Spores: %u of %u, last step %u born, %u died", latestSporePopulation.liveCount,
+                    latestSporePopulation.capacity, latestSporePopulation.births, latestSporePopulation.deaths);
+    }
+
+    if (ImGui::Checkbox("Trail Metrics", &useTrailMetrics)) {
+        // A new series, the snapshot is out of date after any time off
+        metricsHistory.clear();
+        snapshotSporeCount = 0;
+    }
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("%s", "Reduces the trail grid and the spores to a few totals on the GPU every few steps. They are read back a few frames later without waiting on the GPU and kept as a time series.");
+    }
+
+    if (useTrailMetrics) {
+        SliderIntWithTooltip("Metrics Interval", "##MetricsIntervalSlider", &metricsInterval, 1, 120, "Simulation steps between two measurements.");
+
+        if (!metricsHistory.empty()) {
+            const TrailMetricsSample& sample = metricsHistory.back();
+            ImGui::Text("Step %u: mass %.0f, occupied %.2f%%, max %.2f", sample.step, sample.trailMass, 100.0f * sample.occupiedFraction, sample.maxTrail);
+            ImGui::Text("Bounds: (%d, %d, %d) to (%d, %d, %d)", sample.boundsMin[0], sample.boundsMin[1], sample.boundsMin[2],
+                        sample.boundsMax[0], sample.boundsMax[1], sample.boundsMax[2]);
+            ImGui::Text("Spores: %.2f voxels/s, turning %.2f rad/s", sample.meanSporeSpeed, sample.meanTurnRate);
+            ImGui::Text("Metrics: %.2f ms", metricsTimer.latestMilliseconds());
+
+            // Copied out of the series, ImGui plots contiguous floats
+            std::vector<float> massSeries, occupancySeries;
+            for (const TrailMetricsSample& entry : metricsHistory) {
+                massSeries.push_back(static_cast<float>(entry.trailMass));
+                occupancySeries.push_back(100.0f * entry.occupiedFraction);
+            }
+            ImGui::PlotLines("Trail Mass", massSeries.data(), static_cast<int>(massSeries.size()), 0, nullptr, FLT_MAX, FLT_MAX, ImVec2(0, 50));
+            ImGui::PlotLines("Occupied %", occupancySeries.data(), static_cast<int>(occupancySeries.size()), 0, nullptr, FLT_MAX, FLT_MAX, ImVec2(0, 50));
+
+            float histogram[TRAIL_HISTOGRAM_BINS];
+            for (int bin = 0; bin < TRAIL_HISTOGRAM_BINS; ++bin) {
+                histogram[bin] = static_cast<float>(latestTrailMetrics.histogram[bin]);
+            }
+            ImGui::PlotHistogram("Trail Values", histogram, TRAIL_HISTOGRAM_BINS, 0, nullptr, 0.0f, FLT_MAX, ImVec2(0, 50));
+            if (ImGui::IsItemHovered()) {
+                ImGui::SetTooltip("%s", "Occupied voxels by trail value, from just above 0 on the left to 1 and more on the right.");
+            }
+        }
+
+        if (ImGui::Button("Save Metrics")) {
+            saveTrailMetrics("trail_metrics.csv");
+        }
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("%s", "Writes the time series, up to the last 4096 measurements, to trail_metrics.csv.");
+        }
+    }
+
+    if (ImGui::Checkbox("Ensemble", &useEnsemble)) {
+        if (useEnsemble) {
+            initializeEnsembleShaders();
+            configureEnsemble();
+        } else {
+            // Everything derived from the trail and the window were the ensemble's while it ran
+            lastDerivedPassInputs = DerivedPassInputs{};
+            lastFrameInputs = FrameInputs{};
+        }
+    }
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("%s", "Runs many small simulations side by side instead of the large one, shown as a projection of each. "
+                                "Every pass is one dispatch for all of them. They share the settings above except the swept one.");
+    }
+
+    if (useEnsemble) {
+        SliderIntWithTooltip("Members", "##EnsembleMembersSlider", &ensembleMemberCount, 1, MAX_ENSEMBLE_MEMBERS, "Number of simulations, applied on restart.");
+        SliderIntWithTooltip("Member Grid Size", "##EnsembleGridSizeSlider", &ensembleGridSize, 32, 128, "Side length of every member's grid, rounded up to a multiple of 8 and applied on restart.");
+        SliderIntWithTooltip("Member Spores", "##EnsembleSporesSlider", &ensembleSporeCount, 1, 100'000, "Spores of every member, applied on restart.");
+
+        if (ImGui::Button("Restart Ensemble")) {
+            configureEnsemble();
+        }
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("%s", "Reallocates the members with the values above, clears their grids and scatters their spores again.");
+        }
+
+        ImGui::Combo("Swept Setting", &ensembleSweptParameter, ENSEMBLE_SWEPT_PARAMETER_NAMES, IM_ARRAYSIZE(ENSEMBLE_SWEPT_PARAMETER_NAMES));
+        ImGui::InputFloat2("Sweep Range", ensembleSweepRange);
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("%s", "Value of the swept setting for the first and the last member, the ones between are spread evenly. Members fill the view row by row from the bottom left.");
+        }
+
+        SliderFloatWithTooltip("Exposure", "##EnsembleExposureSlider", &projectionExposure, 0.1f, 20.0f, "Multiplies the trail values before they are coloured.");
+
+        // Spore updates per second over all members, the figure that grows with the member count while the GPU has room
+        const float stepMilliseconds = ensembleTimer.latestMilliseconds();
+        ImGui::Text("Ensemble step: %.2f ms, %.1f M spores/s", stepMilliseconds,
+                    stepMilliseconds > 0.0f ? static_cast<float>(ensemble.memberCount()) * static_cast<float>(ensemble.member(0).spore_count) / stepMilliseconds / 1000.0f : 0.0f);
+    }
+
+    if (ImGui::Checkbox("March Statistics", &useMarchStatistics)) {
+        // Only allocated once asked for
+        if (useMarchStatistics && !marchStatisticsBuffer) {
+            initializeMarchStatisticsBuffer();
+        }
+        setShaderVariant(USE_MARCH_STATISTICS_DEFINITION, useMarchStatistics);
+        initializeRenderShader(useTransparency);
+    }
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("%s", "Counts the steps and texel fetches of every marched pixel on the GPU, the atomics slow the ray marchers down somewhat.");
+    }
+
+    if (useMarchStatistics) {
+        marchStatisticsReadback.readLatest(&latestMarchStatistics);
+
+        const MarchStatistics& statistics = latestMarchStatistics;
+        const double pixels = std::max(statistics.pixelCount, 1u);
+        const double meanSteps = static_cast<double>(static_cast<uint64_t>(statistics.stepSumHigh) << 32 | statistics.stepSumLow) / pixels;
+        const double meanFetches = static_cast<double>(static_cast<uint64_t>(statistics.fetchSumHigh) << 32 | statistics.fetchSumLow) / pixels;
+
+        ImGui::Text("Steps/pixel: mean %.1f, p95 %u, max %u", meanSteps,
+                    histogramPercentile(statistics.stepHistogram, MARCH_STEP_BIN_WIDTH, statistics.pixelCount, 0.95f), statistics.maxSteps);
+        ImGui::Text("Fetches/pixel: mean %.1f, p95 %u, max %u", meanFetches,
+                    histogramPercentile(statistics.fetchHistogram, MARCH_FETCH_BIN_WIDTH, statistics.pixelCount, 0.95f), statistics.maxFetches);
+    }
+
+
     bool previousWrappingState = wrapGrid; // Track the previous state
     if (ImGui::Checkbox("Wrap Grid", &wrapGrid)) {
         if (wrapGrid != previousWrappingState) {
             initializeMoveSporesShader(wrapGrid);
+            initializeDecayShaders();
         }
     }
 
 
+    ImGui::Checkbox("CPU SDF", &useCpuSdf);
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("%s", "Builds the SDF with an exact distance transform on the CPU instead of the Jump Flood. Slower, for checking and GPU-less pipelines.");
+    }
+
+    if (ImGui::Button("Measure JFA Error")) {
+        measureJFAError();
+    }
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("%s", "Compares the Jump Flood SDF against the exact CPU distance transform.");
+    }
+    if (jfaErrorMeasured) {
+        ImGui::SameLine();
+        ImGui::Text("max %.2f, mean %.3f voxels, %d missing", jfaError.maxError, jfaError.meanError, jfaError.missingSeeds);
+    }
+
     // Add VSync toggle at the top
     bool currentVSync = GetVsyncStatus();
     if (ImGui::Checkbox("VSync", &currentVSync)) {
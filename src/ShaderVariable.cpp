@@ -20,3 +20,9 @@ template <>
 void ShaderVariable<int>::upload() const {
     glUniform1i(location, *value);
 }
+
+template <>
+void ShaderVariable<mat4x4>::upload() const {
+    // linmath matrices are column major like GLSL
+    glUniformMatrix4fv(location, 1, GL_FALSE, &(*value)[0][0]);
+}
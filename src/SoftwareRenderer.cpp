@@ -0,0 +1,508 @@
+#include "SoftwareRenderer.h"
+#include "OccupancyData.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+    constexpr int LANES = SoftwareRenderer::PACKET_WIDTH;
+
+    // Pixels per tile handed to a thread, a whole number of packets wide
+    constexpr int TILE_WIDTH = LANES * 4;
+    constexpr int TILE_HEIGHT = 8;
+
+    // Same constants as ray_marching.glsl
+    constexpr int NUMBER_OF_STEPS = 500;
+    constexpr float MINIMUM_HIT_DISTANCE = 0.1f;
+    constexpr float SMOOTH_MIN_K = 0.55f;
+    constexpr float EMPTY_VOXEL_VALUE = 0.01f;
+    constexpr float OPACITY_REFERENCE_LENGTH = 1.5f;
+
+    struct Float3 {
+        float x, y, z;
+    };
+
+    Float3 operator+(const Float3 a, const Float3 b) { return {a.x + b.x, a.y + b.y, a.z + b.z}; }
+    Float3 operator-(const Float3 a, const Float3 b) { return {a.x - b.x, a.y - b.y, a.z - b.z}; }
+    Float3 operator*(const Float3 a, const float s) { return {a.x * s, a.y * s, a.z * s}; }
+
+    float length(const Float3 a) { return std::sqrt(a.x * a.x + a.y * a.y + a.z * a.z); }
+    Float3 normalize(const Float3 a) { return a * (1.0f / length(a)); }
+    Float3 cross(const Float3 a, const Float3 b) { return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x}; }
+
+    // Lookups into the scene with the out of range behaviour of imageLoad (zero)
+    class SceneView {
+    public:
+        explicit SceneView(const SoftwareScene& scene)
+            : scene(scene), gridSize(scene.settings.grid_size), reduction(scene.settings.sdf_reduction),
+              reducedSize(scene.settings.grid_size / scene.settings.sdf_reduction) {}
+
+        [[nodiscard]] float trail(const int x, const int y, const int z) const {
+            return scene.trail[x + static_cast<size_t>(gridSize) * (y + static_cast<size_t>(gridSize) * z)];
+        }
+
+        [[nodiscard]] float sdfDistance(const int x, const int y, const int z) const {
+            if (x < 0 || y < 0 || z < 0 || x >= reducedSize || y >= reducedSize || z >= reducedSize) {
+                return 0.0f;
+            }
+            return scene.sdfTexels[(x + static_cast<size_t>(reducedSize) * (y + static_cast<size_t>(reducedSize) * z)) * 4 + 3];
+        }
+
+        [[nodiscard]] uint32_t occupancyWord(const int bx, const int by, const int bz) const {
+            if (bx < 0 || by < 0 || bz < 0 || bx >= scene.brickCountX || by >= scene.brickCountY || bz >= scene.brickCountZ) {
+                return 0;
+            }
+            return scene.occupancyWords[bx + static_cast<size_t>(scene.brickCountX) * (by + static_cast<size_t>(scene.brickCountY) * bz)];
+        }
+
+        static uint32_t occupancyBit(const int x, const int y, const int z) {
+            return 1u << (x % OCCUPANCY_BRICK_X + OCCUPANCY_BRICK_X * (y % OCCUPANCY_BRICK_Y + OCCUPANCY_BRICK_Y * (z % OCCUPANCY_BRICK_Z)));
+        }
+
+        // is_region_empty from OccupancyData.h, the box [lo, hi] is inclusive
+        [[nodiscard]] bool isRegionEmpty(const int lo[3], const int hi[3]) const {
+            const int brickSize[3] = {OCCUPANCY_BRICK_X, OCCUPANCY_BRICK_Y, OCCUPANCY_BRICK_Z};
+
+            for (int bz = lo[2] / brickSize[2]; bz <= hi[2] / brickSize[2]; ++bz) {
+                for (int by = lo[1] / brickSize[1]; by <= hi[1] / brickSize[1]; ++by) {
+                    for (int bx = lo[0] / brickSize[0]; bx <= hi[0] / brickSize[0]; ++bx) {
+                        const uint32_t word = occupancyWord(bx, by, bz);
+                        if (word == 0) {
+                            continue;
+                        }
+
+                        const int brick[3] = {bx, by, bz};
+                        int boxLo[3], boxHi[3];
+                        for (int axis = 0; axis < 3; ++axis) {
+                            const int origin = brick[axis] * brickSize[axis];
+                            boxLo[axis] = std::max(lo[axis], origin) - origin;
+                            boxHi[axis] = std::min(hi[axis], origin + brickSize[axis] - 1) - origin;
+                        }
+
+                        for (int z = boxLo[2]; z <= boxHi[2]; ++z) {
+                            for (int y = boxLo[1]; y <= boxHi[1]; ++y) {
+                                for (int x = boxLo[0]; x <= boxHi[0]; ++x) {
+                                    if (word & 1u << (x + OCCUPANCY_BRICK_X * (y + OCCUPANCY_BRICK_Y * z))) {
+                                        return false;
+                                    }
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+            return true;
+        }
+
+        const SoftwareScene& scene;
+        const int gridSize;
+        const int reduction;
+        const int reducedSize;
+    };
+
+    struct Camera {
+        Float3 position, focus;
+        Float3 forward, right, up;
+        float aspectRatio;
+    };
+
+    Camera makeCamera(const SimulationData& settings) {
+        Camera camera{};
+        camera.position = {settings.camera_position[0], settings.camera_position[1], settings.camera_position[2]};
+        camera.focus = {settings.camera_focus[0], settings.camera_focus[1], settings.camera_focus[2]};
+
+        // camera_ray in ray_marching.glsl
+        camera.forward = normalize(camera.focus - camera.position);
+        camera.right = normalize(cross({0.0f, 1.0f, 0.0f}, camera.forward));
+        camera.up = cross(camera.forward, camera.right);
+        camera.aspectRatio = settings.aspect_ratio;
+        return camera;
+    }
+
+    // One packet of rays side by side, struct of arrays so the lanes load straight into vectors
+    struct RayPacket {
+        float originX[LANES], originY[LANES], originZ[LANES];
+        float directionX[LANES], directionY[LANES], directionZ[LANES];
+        float distance[LANES];
+        bool active[LANES];
+        Float3 color[LANES];
+    };
+
+    // A whole packet in one register (GCC/Clang vector extensions), comparisons give -1 in the lanes where they hold
+    typedef float FloatLanes __attribute__((vector_size(LANES * sizeof(float))));
+    typedef int IntLanes __attribute__((vector_size(LANES * sizeof(int))));
+
+    FloatLanes minLanes(const FloatLanes a, const FloatLanes b) { return a < b ? a : b; }
+    FloatLanes maxLanes(const FloatLanes a, const FloatLanes b) { return a > b ? a : b; }
+    FloatLanes absLanes(const FloatLanes a) { return a < 0.0f ? -a : a; }
+    IntLanes clampLanes(const IntLanes a, const int lo, const int hi) { return a < lo ? lo : a > hi ? hi : a; }
+
+    FloatLanes sqrtLanes(const FloatLanes a) {
+        FloatLanes result;
+        for (int lane = 0; lane < LANES; ++lane) {
+            result[lane] = std::sqrt(a[lane]);
+        }
+        return result;
+    }
+
+    FloatLanes gatherLanes(const float* data, const IntLanes index) {
+        FloatLanes result;
+        for (int lane = 0; lane < LANES; ++lane) {
+            result[lane] = data[index[lane]];
+        }
+        return result;
+    }
+
+    FloatLanes loadLanes(const float values[LANES]) {
+        FloatLanes result;
+        std::memcpy(&result, values, sizeof(result));
+        return result;
+    }
+
+    // map_the_world for every active lane. The SDF and occupancy early outs are per lane, the 27 cube blend
+    // runs offset by offset across all lanes at once.
+    void mapTheWorld(const SceneView& view, const Camera& camera, const float pointX[LANES], const float pointY[LANES],
+                     const float pointZ[LANES], const bool active[LANES], float distances[LANES]) {
+        const int gridSize = view.gridSize;
+        const int reduction = view.reduction;
+        const float cameraCutoutRadius = static_cast<float>(gridSize) / 4.0f;
+
+        IntLanes center[3] = {}, searchMin[3] = {}, searchMax[3] = {};
+        IntLanes near = {};
+        float cameraDistance[LANES];
+        bool anyNear = false;
+
+        for (int lane = 0; lane < LANES; ++lane) {
+            if (!active[lane]) {
+                continue;
+            }
+
+            const int centerX = static_cast<int>(std::floor(pointX[lane]));
+            const int centerY = static_cast<int>(std::floor(pointY[lane]));
+            const int centerZ = static_cast<int>(std::floor(pointZ[lane]));
+
+            const Float3 point = {pointX[lane], pointY[lane], pointZ[lane]};
+            cameraDistance[lane] = length(point - camera.position) - cameraCutoutRadius;
+
+            // Integer division truncates towards zero like GLSL's
+            const float sdf = view.sdfDistance(centerX / reduction, centerY / reduction, centerZ / reduction);
+            if (sdf > static_cast<float>(std::max(reduction, 1)) * 1.8f) {
+                const float skip = std::min(sdf - static_cast<float>(reduction) / 2.0f, static_cast<float>(gridSize) / 2.0f);
+                distances[lane] = std::max(skip, -cameraDistance[lane]);
+                continue;
+            }
+
+            const int lo[3] = {std::max(centerX - 1, 0), std::max(centerY - 1, 0), std::max(centerZ - 1, 0)};
+            const int hi[3] = {std::min(centerX + 1, gridSize - 1), std::min(centerY + 1, gridSize - 1), std::min(centerZ + 1, gridSize - 1)};
+            if (view.isRegionEmpty(lo, hi)) {
+                distances[lane] = std::max(1.0f, -cameraDistance[lane]);
+                continue;
+            }
+
+            center[0][lane] = centerX, center[1][lane] = centerY, center[2][lane] = centerZ;
+            for (int axis = 0; axis < 3; ++axis) {
+                searchMin[axis][lane] = lo[axis];
+                searchMax[axis][lane] = hi[axis];
+            }
+            near[lane] = -1;
+            anyNear = true;
+        }
+
+        if (!anyNear) {
+            return;
+        }
+
+        const FloatLanes point[3] = {loadLanes(pointX), loadLanes(pointY), loadLanes(pointZ)};
+        FloatLanes blend = FloatLanes{} + 1e6f;
+
+        // Same order as the shader's x, y, z loops, smooth_min is not associative
+        for (int dx = -1; dx <= 1; ++dx) {
+            for (int dy = -1; dy <= 1; ++dy) {
+                for (int dz = -1; dz <= 1; ++dz) {
+                    const IntLanes voxel[3] = {center[0] + dx, center[1] + dy, center[2] + dz};
+
+                    IntLanes inside = near;
+                    for (int axis = 0; axis < 3; ++axis) {
+                        inside &= (voxel[axis] >= searchMin[axis]) & (voxel[axis] <= searchMax[axis]);
+                    }
+
+                    // Lanes outside the search box still load, from a clamped voxel, and throw the result away
+                    const IntLanes index = clampLanes(voxel[0], 0, gridSize - 1) +
+                                           gridSize * (clampLanes(voxel[1], 0, gridSize - 1) + gridSize * clampLanes(voxel[2], 0, gridSize - 1));
+                    const FloatLanes value = gatherLanes(view.scene.trail, index);
+
+                    // sdf_cube
+                    const FloatLanes halfSize = value * 0.5f;
+                    FloatLanes offset[3];
+                    for (int axis = 0; axis < 3; ++axis) {
+                        offset[axis] = absLanes(point[axis] - __builtin_convertvector(voxel[axis], FloatLanes)) - halfSize;
+                    }
+                    const FloatLanes outsideX = maxLanes(offset[0], FloatLanes{});
+                    const FloatLanes outsideY = maxLanes(offset[1], FloatLanes{});
+                    const FloatLanes outsideZ = maxLanes(offset[2], FloatLanes{});
+                    const FloatLanes cube = sqrtLanes(outsideX * outsideX + outsideY * outsideY + outsideZ * outsideZ) +
+                                            minLanes(maxLanes(offset[0], maxLanes(offset[1], offset[2])), FloatLanes{});
+
+                    // smooth_min
+                    const FloatLanes h = maxLanes(SMOOTH_MIN_K - absLanes(blend - cube), FloatLanes{}) / SMOOTH_MIN_K;
+                    const FloatLanes blended = minLanes(blend, cube) - h * h * SMOOTH_MIN_K * 0.25f;
+
+                    blend = (inside & (value > EMPTY_VOXEL_VALUE)) ? blended : blend;
+                }
+            }
+        }
+
+        for (int lane = 0; lane < LANES; ++lane) {
+            if (near[lane]) {
+                distances[lane] = std::max(std::min(1.0f, blend[lane]), -cameraDistance[lane]);
+            }
+        }
+    }
+
+    // ray_march: sphere traces every lane until all have hit, left the grid or run out of steps
+    void marchOpaque(const SceneView& view, const Camera& camera, RayPacket& packet) {
+        const float gridSize = static_cast<float>(view.gridSize);
+        const float maximumTraceDistance = gridSize * 1.732f;
+
+        float pointX[LANES], pointY[LANES], pointZ[LANES], distances[LANES];
+
+        for (int step = 0; step < NUMBER_OF_STEPS; ++step) {
+            bool anyActive = false;
+            for (int lane = 0; lane < LANES; ++lane) {
+                if (!packet.active[lane]) {
+                    continue;
+                }
+
+                pointX[lane] = packet.originX[lane] + packet.distance[lane] * packet.directionX[lane];
+                pointY[lane] = packet.originY[lane] + packet.distance[lane] * packet.directionY[lane];
+                pointZ[lane] = packet.originZ[lane] + packet.distance[lane] * packet.directionZ[lane];
+
+                // Left the grid's cube: distance_from_cube(point, camera_focus, grid_size) > 1
+                const float offsetX = std::abs(pointX[lane] - camera.focus.x) - gridSize * 0.5f;
+                const float offsetY = std::abs(pointY[lane] - camera.focus.y) - gridSize * 0.5f;
+                const float offsetZ = std::abs(pointZ[lane] - camera.focus.z) - gridSize * 0.5f;
+                const float outsideDistance = length({std::max(offsetX, 0.0f), std::max(offsetY, 0.0f), std::max(offsetZ, 0.0f)}) +
+                                              std::min(std::max(offsetX, std::max(offsetY, offsetZ)), 0.0f);
+
+                if (packet.distance[lane] > maximumTraceDistance || outsideDistance > 1.0f) {
+                    packet.color[lane] = {static_cast<float>(step) / static_cast<float>(NUMBER_OF_STEPS), 0.0f, 0.0f};
+                    packet.active[lane] = false;
+                    continue;
+                }
+                anyActive = true;
+            }
+
+            if (!anyActive) {
+                return;
+            }
+
+            mapTheWorld(view, camera, pointX, pointY, pointZ, packet.active, distances);
+
+            for (int lane = 0; lane < LANES; ++lane) {
+                if (!packet.active[lane]) {
+                    continue;
+                }
+
+                if (distances[lane] < MINIMUM_HIT_DISTANCE) {
+                    // calculage_lighting only returns the position gradient
+                    packet.color[lane] = {pointX[lane] / gridSize, pointY[lane] / gridSize, pointZ[lane] / gridSize};
+                    packet.active[lane] = false;
+                    continue;
+                }
+                packet.distance[lane] += distances[lane];
+            }
+        }
+    }
+
+    // transparent_skip_distance
+    float transparentSkipDistance(const SceneView& view, const int voxel[3]) {
+        const int reduction = view.reduction;
+        const float sdf = view.sdfDistance(std::clamp(voxel[0] / reduction, 0, view.reducedSize - 1),
+                                           std::clamp(voxel[1] / reduction, 0, view.reducedSize - 1),
+                                           std::clamp(voxel[2] / reduction, 0, view.reducedSize - 1));
+        return sdf - static_cast<float>(2 * reduction - 1) * 1.732f - 0.866f;
+    }
+
+    // ray_march_transparency. The voxel walk diverges from the first step, so each lane walks on its own.
+    Float3 marchTransparent(const SceneView& view, const Camera& camera, const Float3 origin, const Float3 direction) {
+        const int gridSize = view.gridSize;
+        const int maximumIterations = gridSize * 3 + 64;
+        const float maximumTraceDistance = static_cast<float>(gridSize) * 1.732f;
+        const float opacityScaler = 15.0f / static_cast<float>(gridSize);
+        const float cameraCutoutRadius = static_cast<float>(gridSize) / 4.0f;
+        const int brickSize[3] = {OCCUPANCY_BRICK_X, OCCUPANCY_BRICK_Y, OCCUPANCY_BRICK_Z};
+
+        const float rayOrigin[3] = {origin.x, origin.y, origin.z};
+        const float rayDirection[3] = {direction.x, direction.y, direction.z};
+        int voxelStep[3];
+        float tDelta[3], positiveWall[3];
+        for (int axis = 0; axis < 3; ++axis) {
+            voxelStep[axis] = rayDirection[axis] > 0.0f ? 1 : rayDirection[axis] < 0.0f ? -1 : 0;
+            tDelta[axis] = std::abs(1.0f / rayDirection[axis]);
+            positiveWall[axis] = rayDirection[axis] >= 0.0f ? 1.0f : 0.0f;
+        }
+
+        Float3 opacity = {0.0f, 0.0f, 0.0f};
+        float t = 0.0f;
+        int voxel[3] = {0, 0, 0};
+        float tNext[3] = {0.0f, 0.0f, 0.0f};
+        bool restartWalk = true;
+
+        int cachedBrick[3] = {-1, -1, -1};
+        uint32_t brickWord = 0;
+
+        for (int i = 0; i < maximumIterations; ++i) {
+            const float position[3] = {rayOrigin[0] + t * rayDirection[0], rayOrigin[1] + t * rayDirection[1], rayOrigin[2] + t * rayDirection[2]};
+
+            if (restartWalk) {
+                for (int axis = 0; axis < 3; ++axis) {
+                    voxel[axis] = static_cast<int>(std::floor(position[axis] + 0.5f));
+                    tNext[axis] = (static_cast<float>(voxel[axis]) + positiveWall[axis] - 0.5f - rayOrigin[axis]) / rayDirection[axis];
+                }
+                restartWalk = false;
+            }
+
+            bool outsideGrid = false;
+            for (const int coordinate : voxel) {
+                outsideGrid |= coordinate < 0 || coordinate >= gridSize;
+            }
+            if ((outsideGrid && t > 1.0f) || t > maximumTraceDistance) {
+                break;
+            }
+
+            const int brick[3] = {voxel[0] / brickSize[0], voxel[1] / brickSize[1], voxel[2] / brickSize[2]};
+            if (brick[0] != cachedBrick[0] || brick[1] != cachedBrick[1] || brick[2] != cachedBrick[2]) {
+                std::copy(brick, brick + 3, cachedBrick);
+                brickWord = outsideGrid ? 0 : view.occupancyWord(brick[0], brick[1], brick[2]);
+            }
+
+            if (brickWord == 0 && !outsideGrid) {
+                // Empty brick, jump to its far wall or further when the SDF allows it
+                float exitDistance = 1e30f;
+                for (int axis = 0; axis < 3; ++axis) {
+                    const float wall = static_cast<float>(brick[axis] * brickSize[axis]) - 0.5f + positiveWall[axis] * static_cast<float>(brickSize[axis]);
+                    exitDistance = std::min(exitDistance, (wall - position[axis]) / rayDirection[axis]);
+                }
+
+                const float skipDistance = std::max(exitDistance, transparentSkipDistance(view, voxel));
+                t += std::max(skipDistance, 0.0f) + 0.001f;
+                restartWalk = true;
+                continue;
+            }
+
+            const float voxelValue = brickWord & SceneView::occupancyBit(voxel[0], voxel[1], voxel[2]) ? view.trail(voxel[0], voxel[1], voxel[2]) : 0.0f;
+
+            // Length of the ray inside this voxel, then step across the nearest wall
+            const Float3 currentVoxel = {static_cast<float>(voxel[0]), static_cast<float>(voxel[1]), static_cast<float>(voxel[2])};
+            const int axis = tNext[0] < tNext[1] && tNext[0] < tNext[2] ? 0 : tNext[1] < tNext[2] ? 1 : 2;
+            const float tExit = tNext[axis];
+            tNext[axis] += tDelta[axis];
+            voxel[axis] += voxelStep[axis];
+
+            const float segmentLength = std::max(tExit - t, 0.0f);
+            t = tExit;
+
+            const Float3 point = {position[0], position[1], position[2]};
+            if (voxelValue <= 0.0f || length(point - camera.position) - cameraCutoutRadius < 0.0f) {
+                continue;
+            }
+
+            const float opacityAmount = voxelValue * opacityScaler * segmentLength / OPACITY_REFERENCE_LENGTH;
+            opacity = opacity + currentVoxel * (opacityAmount / static_cast<float>(gridSize));
+
+            if (std::max(opacity.x, std::max(opacity.y, opacity.z)) >= 1.0f) {
+                break;
+            }
+        }
+
+        return opacity;
+    }
+
+    // intersectsAABB, returns false when the ray misses the box
+    bool intersectsBox(const Float3 origin, const Float3 direction, const float boxMin, const float boxMax, float& tNear) {
+        const float o[3] = {origin.x, origin.y, origin.z};
+        const float d[3] = {direction.x, direction.y, direction.z};
+        tNear = -1e30f;
+        float tFar = 1e30f;
+        for (int axis = 0; axis < 3; ++axis) {
+            const float t0 = (boxMin - o[axis]) / d[axis];
+            const float t1 = (boxMax - o[axis]) / d[axis];
+            tNear = std::max(tNear, std::min(t0, t1));
+            tFar = std::min(tFar, std::max(t0, t1));
+        }
+        return tNear <= tFar && tFar >= 0.0f;
+    }
+
+    uint8_t toByte(const float value) {
+        return static_cast<uint8_t>(std::clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+    }
+}
+
+SoftwareRenderer::SoftwareRenderer(ThreadPool& threadPool) : pool(threadPool) {}
+
+void SoftwareRenderer::render(const SoftwareScene& scene, const int width, const int height, const bool transparent, std::vector<uint8_t>& rgba) {
+    rgba.assign(static_cast<size_t>(width) * height * 4, 0);
+    if (width < 1 || height < 1) {
+        return;
+    }
+
+    const SceneView view(scene);
+    const Camera camera = makeCamera(scene.settings);
+
+    const int tilesX = (width + TILE_WIDTH - 1) / TILE_WIDTH;
+    const int tilesY = (height + TILE_HEIGHT - 1) / TILE_HEIGHT;
+
+    pool.parallelFor(0, tilesX * tilesY, [&](const int tile) {
+        const int tileX = tile % tilesX * TILE_WIDTH;
+        const int tileY = tile / tilesX * TILE_HEIGHT;
+
+        for (int y = tileY; y < std::min(tileY + TILE_HEIGHT, height); ++y) {
+            for (int packetX = tileX; packetX < std::min(tileX + TILE_WIDTH, width); packetX += LANES) {
+                RayPacket packet{};
+
+                for (int lane = 0; lane < LANES; ++lane) {
+                    const int x = packetX + lane;
+                    if (x >= width) {
+                        continue;
+                    }
+
+                    // Pixel centres in [-1, 1] like the full-screen quad's uv
+                    const float u = (static_cast<float>(x) + 0.5f) / static_cast<float>(width) * 2.0f - 1.0f;
+                    const float v = (static_cast<float>(y) + 0.5f) / static_cast<float>(height) * 2.0f - 1.0f;
+                    const Float3 direction = normalize(camera.right * (u * camera.aspectRatio) + camera.up * v + camera.forward);
+
+                    float tNear;
+                    const float gridMax = static_cast<float>(view.gridSize - 1) + 0.5f;
+                    if (!intersectsBox(camera.position, direction, -0.5f, gridMax, tNear)) {
+                        continue;
+                    }
+
+                    const Float3 origin = camera.position + direction * std::max(tNear - 0.001f, 0.0f);
+                    packet.originX[lane] = origin.x, packet.originY[lane] = origin.y, packet.originZ[lane] = origin.z;
+                    packet.directionX[lane] = direction.x, packet.directionY[lane] = direction.y, packet.directionZ[lane] = direction.z;
+                    packet.active[lane] = true;
+                }
+
+                if (transparent) {
+                    for (int lane = 0; lane < LANES; ++lane) {
+                        if (packet.active[lane]) {
+                            packet.color[lane] = marchTransparent(view, camera, {packet.originX[lane], packet.originY[lane], packet.originZ[lane]},
+                                                                  {packet.directionX[lane], packet.directionY[lane], packet.directionZ[lane]});
+                        }
+                    }
+                } else {
+                    marchOpaque(view, camera, packet);
+                }
+
+                for (int lane = 0; lane < LANES && packetX + lane < width; ++lane) {
+                    uint8_t* pixel = &rgba[(static_cast<size_t>(y) * width + packetX + lane) * 4];
+                    pixel[0] = toByte(packet.color[lane].x);
+                    pixel[1] = toByte(packet.color[lane].y);
+                    pixel[2] = toByte(packet.color[lane].z);
+                    pixel[3] = 255;
+                }
+            }
+        }
+    });
+}
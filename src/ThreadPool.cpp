@@ -0,0 +1,83 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(const unsigned int threadCount) {
+    // The calling thread takes part in every parallelFor, so spawn one less
+    const unsigned int workerCount = std::max(1u, threadCount) - 1;
+
+    workers.reserve(workerCount);
+    for (unsigned int i = 0; i < workerCount; ++i) {
+        workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+    }
+    wakeCondition.notify_all();
+
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+unsigned int ThreadPool::size() const {
+    return static_cast<unsigned int>(workers.size()) + 1;
+}
+
+void ThreadPool::parallelFor(const int begin, const int end, const std::function<void(int)>& task) {
+    if (begin >= end) {
+        return;
+    }
+
+    {
+        std::lock_guard lock(mutex);
+        currentTask = &task;
+        nextIndex = begin;
+        endIndex = end;
+        busyWorkers = workers.size();
+        ++generation;
+    }
+    wakeCondition.notify_all();
+
+    runTasks(task);
+
+    std::unique_lock lock(mutex);
+    doneCondition.wait(lock, [this] { return busyWorkers == 0; });
+    currentTask = nullptr;
+}
+
+void ThreadPool::runTasks(const std::function<void(int)>& task) {
+    for (int i = nextIndex++; i < endIndex; i = nextIndex++) {
+        task(i);
+    }
+}
+
+void ThreadPool::workerLoop() {
+    uint64_t seenGeneration = 0;
+
+    while (true) {
+        const std::function<void(int)>* task;
+        {
+            std::unique_lock lock(mutex);
+            wakeCondition.wait(lock, [&] { return stopping || generation != seenGeneration; });
+            if (stopping) {
+                return;
+            }
+            seenGeneration = generation;
+            task = currentTask;
+        }
+
+        runTasks(*task);
+
+        {
+            std::lock_guard lock(mutex);
+            if (--busyWorkers == 0) {
+                doneCondition.notify_one();
+            }
+        }
+    }
+}
@@ -0,0 +1,104 @@
+#include "TrailProjection.h"
+
+#include <algorithm>
+#include <vector>
+#include "ImageIO.h"
+
+// Only eight image units are guaranteed, the projection borrows the pyramid's write unit like the bake does
+constexpr int PROJECTION_WRITE_LOCATION = 5;
+constexpr int PROJECTION_WORK_GROUP_SIZE = 64;
+
+TrailProjection::~TrailProjection() {
+    if (image)
+        glDeleteTextures(1, &image);
+}
+
+void TrailProjection::setProgram(const GLuint projectionProgram) {
+    program = projectionProgram;
+    axisSV = ShaderVariable(program, &axis, "projectionAxis");
+    kindSV = ShaderVariable(program, &kind, "projectionKind");
+    sliceSV = ShaderVariable(program, &slice, "sliceIndex");
+    upToDate = false;
+}
+
+void TrailProjection::project(const int gridSize, const ProjectionSettings& settings, const uint64_t trailGeneration) {
+    if (upToDate && gridSize == imageSize && settings == lastSettings && trailGeneration == lastTrailGeneration) {
+        return;
+    }
+
+    // Created on first use and whenever the grid size changes
+    if (gridSize != imageSize) {
+        if (image) {
+            glDeleteTextures(1, &image);
+        }
+        glGenTextures(1, &image);
+        glBindTexture(GL_TEXTURE_2D, image);
+        glTexStorage2D(GL_TEXTURE_2D, 1, GL_R32F, gridSize, gridSize);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        imageSize = gridSize;
+    }
+
+    glUseProgram(program);
+    axis = settings.axis;
+    kind = static_cast<int>(settings.kind);
+    slice = settings.slice;
+    axisSV.uploadToShader();
+    kindSV.uploadToShader();
+    sliceSV.uploadToShader();
+
+    // One work group per texel
+    glBindImageTexture(PROJECTION_WRITE_LOCATION, image, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+    glDispatchCompute(gridSize, gridSize, 1);
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_TEXTURE_UPDATE_BARRIER_BIT);
+
+    lastSettings = settings;
+    lastTrailGeneration = trailGeneration;
+    upToDate = true;
+}
+
+bool TrailProjection::saveThumbnail(const std::string& path, const int maxSize, const float exposure) const {
+    if (!image || maxSize < 1) {
+        return false;
+    }
+
+    std::vector<float> values(static_cast<size_t>(imageSize) * imageSize);
+    glBindTexture(GL_TEXTURE_2D, image);
+    glGetTexImage(GL_TEXTURE_2D, 0, GL_RED, GL_FLOAT, values.data());
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    // Every thumbnail pixel averages the block of texels it covers
+    const int thumbnailSize = std::min(maxSize, imageSize);
+    std::vector<uint8_t> rgba(static_cast<size_t>(thumbnailSize) * thumbnailSize * 4);
+
+    for (int y = 0; y < thumbnailSize; ++y) {
+        const int y0 = y * imageSize / thumbnailSize;
+        const int y1 = std::max(y0 + 1, (y + 1) * imageSize / thumbnailSize);
+        for (int x = 0; x < thumbnailSize; ++x) {
+            const int x0 = x * imageSize / thumbnailSize;
+            const int x1 = std::max(x0 + 1, (x + 1) * imageSize / thumbnailSize);
+
+            float sum = 0.0f;
+            for (int row = y0; row < y1; ++row) {
+                for (int column = x0; column < x1; ++column) {
+                    sum += values[static_cast<size_t>(row) * imageSize + column];
+                }
+            }
+
+            uint8_t* pixel = &rgba[(static_cast<size_t>(y) * thumbnailSize + x) * 4];
+            heatColor(sum / static_cast<float>((y1 - y0) * (x1 - x0)) * exposure, pixel);
+            pixel[3] = 255;
+        }
+    }
+
+    // Rows are bottom first like the image
+    return ImageIO::savePPM(path, thumbnailSize, thumbnailSize, rgba);
+}
+
+void TrailProjection::heatColor(const float value, uint8_t rgb[3]) {
+    for (int channel = 0; channel < 3; ++channel) {
+        const float intensity = std::clamp(value * 3.0f - static_cast<float>(channel), 0.0f, 1.0f);
+        rgb[channel] = static_cast<uint8_t>(intensity * 255.0f + 0.5f);
+    }
+}
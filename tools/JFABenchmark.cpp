@@ -0,0 +1,465 @@
+// Jump flood quality/performance benchmark.
+// Runs jump_flood_init/jump_flood_step over a matrix of grid sizes, SDF reductions and step schedules on a reproducible trail
+// field, times every pass on the GPU and compares the result against the exact CPU distance transform.
+//
+// Usage: MoldLab3DJFABenchmark [--sizes 100,200,400] [--reductions 1,2,4] [--schedules jfa,jfa+1,1+jfa] [--fill 0.02]
+//                              [--seed 1] [--repeats 3] [--field trail.raw] [--json jfa.json] [--csv jfa.csv]
+// Run from the repository root so the shaders and include/ definitions are found.
+
+#include <linmath.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "GameEngine.h"
+#include "DistanceTransform.h"
+#include "GpuTimer.h"
+#include "OccupancyData.h"
+#include "ShaderVariable.h"
+#include "SimulationData.h"
+
+namespace {
+    constexpr int GRID_TEXTURE_LOCATION = 0;
+    constexpr int SDF_TEXTURE_READ_LOCATION = 1;
+    constexpr int SDF_TEXTURE_WRITE_LOCATION = 2;
+    constexpr int OCCUPANCY_TEXTURE_LOCATION = 3;
+    constexpr int SIMULATION_BUFFER_LOCATION = 1;
+
+    struct BenchmarkOptions {
+        std::vector<int> gridSizes{100, 200, 400};
+        std::vector<int> reductions{1, 2, 4};
+        std::vector<std::string> schedules{"jfa", "jfa+1", "1+jfa"};
+        float fillFraction = 0.02f; // Fraction of voxels the generated trails cover
+        unsigned int seed = 1;
+        int repeats = 3;
+        std::string fieldPath;      // Raw float32 cube, replaces the generated field when set
+        std::string jsonPath = "jfa_benchmark.json";
+        std::string csvPath = "jfa_benchmark.csv";
+    };
+
+    struct BenchmarkResult {
+        int gridSize = 0;
+        int reduction = 0;
+        std::string schedule;
+        int rounds = 0;
+        float initMilliseconds = 0.0f;
+        std::vector<float> roundMilliseconds; // Mean over the repeats, one per step
+        float totalMilliseconds = 0.0f;
+        float cpuMilliseconds = 0.0f;         // Exact transform on the CPU, including the seed pass
+        DistanceFieldError error{};
+    };
+
+    std::vector<std::string> splitList(const std::string& list) {
+        std::vector<std::string> items;
+        std::stringstream stream(list);
+        std::string item;
+        while (std::getline(stream, item, ',')) {
+            if (!item.empty()) {
+                items.push_back(item);
+            }
+        }
+        return items;
+    }
+
+    std::vector<int> parseIntList(const std::string& list) {
+        std::vector<int> values;
+        for (const std::string& item : splitList(list)) {
+            values.push_back(std::stoi(item));
+        }
+        return values;
+    }
+
+    BenchmarkOptions parseOptions(const int argc, char** argv) {
+        BenchmarkOptions options;
+
+        for (int i = 1; i < argc; ++i) {
+            const std::string argument = argv[i];
+            if (i + 1 >= argc) {
+                throw std::runtime_error("Missing value for " + argument);
+            }
+            const std::string value = argv[++i];
+
+            if (argument == "--sizes") {
+                options.gridSizes = parseIntList(value);
+            } else if (argument == "--reductions") {
+                options.reductions = parseIntList(value);
+            } else if (argument == "--schedules") {
+                options.schedules = splitList(value);
+            } else if (argument == "--fill") {
+                options.fillFraction = std::stof(value);
+            } else if (argument == "--seed") {
+                options.seed = static_cast<unsigned int>(std::stoul(value));
+            } else if (argument == "--repeats") {
+                options.repeats = std::max(1, std::stoi(value));
+            } else if (argument == "--field") {
+                options.fieldPath = value;
+            } else if (argument == "--json") {
+                options.jsonPath = value;
+            } else if (argument == "--csv") {
+                options.csvPath = value;
+            } else {
+                throw std::runtime_error("Unknown argument " + argument);
+            }
+        }
+
+        return options;
+    }
+
+    // Step sizes of one flood. "jfa" halves from the largest power of two below the grid like MoldLabGame::executeJFA,
+    // "jfa+1" adds a final step of 1, "1+jfa" starts with one.
+    std::vector<int> stepSchedule(const std::string& schedule, const int reducedGridSize) {
+        std::vector<int> steps;
+
+        int stepSize = 1;
+        while (stepSize * 2 < reducedGridSize) {
+            stepSize *= 2;
+        }
+        for (; stepSize >= 1; stepSize /= 2) {
+            steps.push_back(stepSize);
+        }
+
+        if (schedule == "jfa+1") {
+            steps.push_back(1);
+        } else if (schedule == "1+jfa") {
+            steps.insert(steps.begin(), 1);
+        } else if (schedule != "jfa") {
+            throw std::runtime_error("Unknown JFA schedule " + schedule);
+        }
+
+        return steps;
+    }
+
+    // Trails shaped like the simulation's: random walkers with slowly turning headings, marking every voxel they cross
+    std::vector<float> generateTrailField(const int gridSize, const float fillFraction, const unsigned int seed) {
+        const size_t voxelCount = static_cast<size_t>(gridSize) * gridSize * gridSize;
+        const size_t targetVoxels = std::max<size_t>(1, static_cast<size_t>(static_cast<double>(voxelCount) * fillFraction));
+
+        std::vector<float> field(voxelCount, 0.0f);
+        std::mt19937 random(seed);
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        std::normal_distribution<float> turn(0.0f, 0.15f);
+
+        size_t markedVoxels = 0;
+        while (markedVoxels < targetVoxels) {
+            float position[3] = {unit(random) * gridSize, unit(random) * gridSize, unit(random) * gridSize};
+            float heading[3] = {turn(random), turn(random), turn(random)};
+
+            for (int step = 0; step < gridSize * 2 && markedVoxels < targetVoxels; ++step) {
+                for (float& component : heading) {
+                    component += turn(random);
+                }
+                const float length = std::sqrt(heading[0] * heading[0] + heading[1] * heading[1] + heading[2] * heading[2]);
+                if (length <= 0.0f) {
+                    continue;
+                }
+
+                bool inside = true;
+                int voxel[3];
+                for (int axis = 0; axis < 3; ++axis) {
+                    heading[axis] /= length;
+                    position[axis] += heading[axis];
+                    voxel[axis] = static_cast<int>(std::floor(position[axis]));
+                    inside &= voxel[axis] >= 0 && voxel[axis] < gridSize;
+                }
+                if (!inside) {
+                    break;
+                }
+
+                float& value = field[voxel[0] + gridSize * (voxel[1] + static_cast<size_t>(gridSize) * voxel[2])];
+                if (value == 0.0f) {
+                    value = 0.25f + 0.75f * unit(random);
+                    ++markedVoxels;
+                }
+            }
+        }
+
+        return field;
+    }
+
+    std::vector<float> loadTrailField(const std::string& path, int& gridSize) {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file) {
+            throw std::runtime_error("Failed to open trail field " + path);
+        }
+
+        const size_t voxelCount = static_cast<size_t>(file.tellg()) / sizeof(float);
+        gridSize = static_cast<int>(std::lround(std::cbrt(static_cast<double>(voxelCount))));
+        if (static_cast<size_t>(gridSize) * gridSize * gridSize != voxelCount) {
+            throw std::runtime_error("Trail field " + path + " is not a cube of float32 voxels");
+        }
+
+        std::vector<float> field(voxelCount);
+        file.seekg(0);
+        file.read(reinterpret_cast<char*>(field.data()), static_cast<std::streamsize>(voxelCount * sizeof(float)));
+        return field;
+    }
+
+    GLuint createTexture3D(const GLenum internalFormat, const int sizeX, const int sizeY, const int sizeZ) {
+        GLuint texture = 0;
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_3D, texture);
+        glTexStorage3D(GL_TEXTURE_3D, 1, internalFormat, sizeX, sizeY, sizeZ);
+        glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glBindTexture(GL_TEXTURE_3D, 0);
+        return texture;
+    }
+}
+
+
+class JFABenchmark : public GameEngine {
+public:
+    explicit JFABenchmark(BenchmarkOptions options)
+        : GameEngine(64, 64, "MoldLab3D JFA Benchmark", false, true), options(std::move(options)) {
+        addShaderDefinition("#define SIMULATION_SETTINGS", "include/SimulationData.h");
+        addShaderDefinition("#define OCCUPANCY_DATA", "include/OccupancyData.h");
+        // The decay only rebuilds the occupancy of a single grid, without the ensemble's members or wrapping
+        setShaderVariant("#define USE_ENSEMBLE", false);
+        setShaderVariant("#define WRAP_AROUND", false);
+        // The benchmark dispatches the decay over the whole grid, it never runs diffuse_trail.glsl
+        setShaderVariant("#define USE_DIFFUSION", false);
+    }
+
+    ~JFABenchmark() override {
+        if (settingsBuffer)
+            glDeleteBuffers(1, &settingsBuffer);
+    }
+
+    void runAll() {
+        renderingStart();
+
+        for (const int requestedSize : options.gridSizes) {
+            int gridSize = requestedSize;
+            const std::vector<float> field = options.fieldPath.empty()
+                ? generateTrailField(gridSize, options.fillFraction, options.seed + static_cast<unsigned int>(gridSize))
+                : loadTrailField(options.fieldPath, gridSize);
+
+            for (const int reduction : options.reductions) {
+                if (reduction < 1 || gridSize / reduction < 1) {
+                    continue;
+                }
+                for (const std::string& schedule : options.schedules) {
+                    results.push_back(runCase(field, gridSize, reduction, schedule));
+                    printResult(results.back());
+                }
+            }
+
+            if (!options.fieldPath.empty()) {
+                break; // A loaded field has a single size
+            }
+        }
+
+        writeJson();
+        writeCsv();
+    }
+
+protected:
+    void renderingStart() override {
+        decayShaderProgram = CreateShaderProgram({{"shaders/decay_spores.glsl", GL_COMPUTE_SHADER, false}});
+        jumpFloodInitShaderProgram = CreateShaderProgram({{"shaders/jump_flood_init.glsl", GL_COMPUTE_SHADER, false}});
+        jumpFloodStepShaderProgram = CreateShaderProgram({{"shaders/jump_flood_step.glsl", GL_COMPUTE_SHADER, false}});
+
+        jfaStepSV = ShaderVariable(jumpFloodStepShaderProgram, &jfaStep, "stepSize");
+
+        glGenBuffers(1, &settingsBuffer);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, settingsBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(SimulationData), nullptr, GL_DYNAMIC_DRAW);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, SIMULATION_BUFFER_LOCATION, settingsBuffer);
+    }
+
+    void start() override {}
+    void update(float) override {}
+    void render() override {}
+    void renderUI() override {}
+
+private:
+    BenchmarkResult runCase(const std::vector<float>& field, const int gridSize, const int reduction, const std::string& schedule) {
+        BenchmarkResult result;
+        result.gridSize = gridSize;
+        result.reduction = reduction;
+        result.schedule = schedule;
+
+        const int reducedGridSize = gridSize / reduction;
+        const std::vector<int> steps = stepSchedule(schedule, reducedGridSize);
+        result.rounds = static_cast<int>(steps.size());
+        result.roundMilliseconds.assign(steps.size(), 0.0f);
+
+        SimulationData settings{};
+        settings.grid_size = gridSize;
+        settings.sdf_reduction = reduction;
+        settings.decay_speed = 0.0f; // Decay only rebuilds the occupancy bricks, the trail stays as generated
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, settingsBuffer);
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(SimulationData), &settings);
+
+        const int bricksX = (gridSize + OCCUPANCY_BRICK_X - 1) / OCCUPANCY_BRICK_X;
+        const int bricksY = (gridSize + OCCUPANCY_BRICK_Y - 1) / OCCUPANCY_BRICK_Y;
+        const int bricksZ = (gridSize + OCCUPANCY_BRICK_Z - 1) / OCCUPANCY_BRICK_Z;
+
+        const GLuint gridTexture = createTexture3D(GL_R32F, gridSize, gridSize, gridSize);
+        const GLuint occupancyTexture = createTexture3D(GL_R32UI, bricksX, bricksY, bricksZ);
+        GLuint sdfTextures[2] = {
+            createTexture3D(GL_RGBA32F, reducedGridSize, reducedGridSize, reducedGridSize),
+            createTexture3D(GL_RGBA32F, reducedGridSize, reducedGridSize, reducedGridSize)
+        };
+
+        glBindTexture(GL_TEXTURE_3D, gridTexture);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexSubImage3D(GL_TEXTURE_3D, 0, 0, 0, 0, gridSize, gridSize, gridSize, GL_RED, GL_FLOAT, field.data());
+        glBindTexture(GL_TEXTURE_3D, 0);
+
+        glBindImageTexture(GRID_TEXTURE_LOCATION, gridTexture, 0, GL_TRUE, 0, GL_READ_WRITE, GL_R32F);
+        glBindImageTexture(OCCUPANCY_TEXTURE_LOCATION, occupancyTexture, 0, GL_TRUE, 0, GL_READ_WRITE, GL_R32UI);
+
+        DispatchComputeShader(decayShaderProgram, gridSize, gridSize, gridSize);
+        glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+
+        GLuint resultTexture = sdfTextures[0];
+        for (int repeat = 0; repeat < options.repeats; ++repeat) {
+            GLuint readTexture = sdfTextures[0];
+            GLuint writeTexture = sdfTextures[1];
+
+            glBindImageTexture(SDF_TEXTURE_READ_LOCATION, readTexture, 0, GL_TRUE, 0, GL_WRITE_ONLY, GL_RGBA32F);
+            timer.begin();
+            DispatchComputeShader(jumpFloodInitShaderProgram, reducedGridSize, reducedGridSize, reducedGridSize);
+            timer.end();
+            glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+            result.initMilliseconds += timer.waitMilliseconds() / static_cast<float>(options.repeats);
+
+            glUseProgram(jumpFloodStepShaderProgram);
+            for (size_t round = 0; round < steps.size(); ++round) {
+                glBindImageTexture(SDF_TEXTURE_READ_LOCATION, readTexture, 0, GL_TRUE, 0, GL_READ_ONLY, GL_RGBA32F);
+                glBindImageTexture(SDF_TEXTURE_WRITE_LOCATION, writeTexture, 0, GL_TRUE, 0, GL_WRITE_ONLY, GL_RGBA32F);
+
+                jfaStep = steps[round];
+                jfaStepSV.uploadToShader();
+
+                timer.begin();
+                DispatchComputeShader(jumpFloodStepShaderProgram, reducedGridSize, reducedGridSize, reducedGridSize);
+                timer.end();
+                glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+                result.roundMilliseconds[round] += timer.waitMilliseconds() / static_cast<float>(options.repeats);
+
+                std::swap(readTexture, writeTexture);
+            }
+            resultTexture = readTexture;
+        }
+
+        result.totalMilliseconds = result.initMilliseconds;
+        for (const float milliseconds : result.roundMilliseconds) {
+            result.totalMilliseconds += milliseconds;
+        }
+
+        // Exact reference from the same occupancy bricks the jump flood was seeded from
+        glMemoryBarrier(GL_TEXTURE_UPDATE_BARRIER_BIT);
+        std::vector<uint32_t> occupancyWords(static_cast<size_t>(bricksX) * bricksY * bricksZ);
+        glBindTexture(GL_TEXTURE_3D, occupancyTexture);
+        glGetTexImage(GL_TEXTURE_3D, 0, GL_RED_INTEGER, GL_UNSIGNED_INT, occupancyWords.data());
+
+        std::vector<float> jfaTexels(static_cast<size_t>(reducedGridSize) * reducedGridSize * reducedGridSize * 4);
+        glBindTexture(GL_TEXTURE_3D, resultTexture);
+        glGetTexImage(GL_TEXTURE_3D, 0, GL_RGBA, GL_FLOAT, jfaTexels.data());
+        glBindTexture(GL_TEXTURE_3D, 0);
+
+        const auto cpuStart = std::chrono::steady_clock::now();
+        distanceTransform.seedsFromOccupancy(occupancyWords, bricksX, bricksY, gridSize, reduction, seeds);
+        distanceTransform.compute(seeds, reducedGridSize, reduction, referenceTexels);
+        result.cpuMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - cpuStart).count();
+
+        result.error = DistanceTransform::compare(referenceTexels, jfaTexels);
+
+        glDeleteTextures(1, &gridTexture);
+        glDeleteTextures(1, &occupancyTexture);
+        glDeleteTextures(2, sdfTextures);
+        CheckGLError("JFA benchmark case");
+
+        return result;
+    }
+
+    static void printResult(const BenchmarkResult& result) {
+        std::cout << "grid " << result.gridSize << " reduction " << result.reduction << " " << result.schedule
+                  << ": " << result.rounds << " rounds, " << result.totalMilliseconds << " ms GPU, "
+                  << result.cpuMilliseconds << " ms CPU, max error " << result.error.maxError
+                  << ", mean error " << result.error.meanError << ", missing " << result.error.missingSeeds << std::endl;
+    }
+
+    void writeJson() const {
+        std::ofstream file(options.jsonPath);
+        if (!file) {
+            std::cerr << "Failed to write " << options.jsonPath << std::endl;
+            return;
+        }
+
+        file << "[\n";
+        for (size_t i = 0; i < results.size(); ++i) {
+            const BenchmarkResult& result = results[i];
+            file << "  {\"grid_size\": " << result.gridSize
+                 << ", \"reduction\": " << result.reduction
+                 << ", \"schedule\": \"" << result.schedule << "\""
+                 << ", \"rounds\": " << result.rounds
+                 << ", \"init_ms\": " << result.initMilliseconds
+                 << ", \"round_ms\": [";
+            for (size_t round = 0; round < result.roundMilliseconds.size(); ++round) {
+                file << (round ? ", " : "") << result.roundMilliseconds[round];
+            }
+            file << "], \"total_ms\": " << result.totalMilliseconds
+                 << ", \"cpu_edt_ms\": " << result.cpuMilliseconds
+                 << ", \"max_error\": " << result.error.maxError
+                 << ", \"mean_error\": " << result.error.meanError
+                 << ", \"missing_seeds\": " << result.error.missingSeeds
+                 << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+        file << "]\n";
+    }
+
+    void writeCsv() const {
+        std::ofstream file(options.csvPath);
+        if (!file) {
+            std::cerr << "Failed to write " << options.csvPath << std::endl;
+            return;
+        }
+
+        file << "grid_size,reduction,schedule,rounds,init_ms,mean_round_ms,total_ms,cpu_edt_ms,max_error,mean_error,missing_seeds\n";
+        for (const BenchmarkResult& result : results) {
+            const float meanRound = result.rounds > 0
+                ? (result.totalMilliseconds - result.initMilliseconds) / static_cast<float>(result.rounds) : 0.0f;
+            file << result.gridSize << ',' << result.reduction << ',' << result.schedule << ',' << result.rounds << ','
+                 << result.initMilliseconds << ',' << meanRound << ',' << result.totalMilliseconds << ','
+                 << result.cpuMilliseconds << ',' << result.error.maxError << ',' << result.error.meanError << ','
+                 << result.error.missingSeeds << '\n';
+        }
+    }
+
+    BenchmarkOptions options;
+    std::vector<BenchmarkResult> results;
+
+    GLuint settingsBuffer = 0;
+    GLuint decayShaderProgram = 0, jumpFloodInitShaderProgram = 0, jumpFloodStepShaderProgram = 0;
+    int jfaStep = 1;
+    ShaderVariable<int> jfaStepSV;
+
+    GpuTimer timer;
+    ThreadPool threadPool;
+    DistanceTransform distanceTransform{threadPool};
+    std::vector<uint8_t> seeds;
+    std::vector<float> referenceTexels;
+};
+
+
+int main(const int argc, char** argv) {
+    try {
+        JFABenchmark benchmark(parseOptions(argc, argv));
+        benchmark.runAll();
+    } catch (const std::exception& exception) {
+        std::cerr << exception.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
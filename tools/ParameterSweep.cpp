@@ -0,0 +1,410 @@
+// Headless parameter sweep.
+// Runs every combination of the given spore settings for a fixed number of steps and writes the trail metrics of each
+// run. Runs go through Ensemble in batches, a batch is simulated side by side with one dispatch per pass for all of
+// its runs. Every run starts from the spores of the same seed and steps with a fixed delta time, so reruns reproduce
+// the metrics.
+//
+// Usage: MoldLab3DSweep [--spore-speed 5,10,20] [--turn-speed 1] [--decay-speed 0.33] [--sensor-distance 10]
+//                       [--sensor-angle 1.57] [--grid 64] [--spores 20000] [--steps 600] [--delta-time 0.0167]
+//                       [--seed 1] [--batch 16] [--wrap 1] [--trilinear 0] [--thumbnails sweep] [--json sweep.json]
+//                       [--csv sweep.csv]
+// Run from the repository root so the shaders and include/ definitions are found.
+
+#include <linmath.h>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "GameEngine.h"
+#include "Ensemble.h"
+#include "GpuTimer.h"
+#include "MoldLabGame.h"
+#include "Random.h"
+#include "SimulationData.h"
+#include "TrailProjection.h"
+
+namespace {
+    constexpr const char* USAGE =
+        "Usage: MoldLab3DSweep [--spore-speed 5,10,20] [--turn-speed 1] [--decay-speed 0.33] [--sensor-distance 10]\n"
+        "                      [--sensor-angle 1.57] [--grid 64] [--spores 20000] [--steps 600] [--delta-time 0.0167]\n"
+        "                      [--seed 1] [--batch 16] [--wrap 1] [--trilinear 0] [--thumbnails sweep] [--json sweep.json]\n"
+        "                      [--csv sweep.csv]";
+
+    struct SweepOptions {
+        std::vector<float> sporeSpeeds{SimulationDefaults::SPORE_SPEED};
+        std::vector<float> turnSpeeds{SimulationDefaults::SPORE_TURN_SPEED};
+        std::vector<float> decaySpeeds{SimulationDefaults::SPORE_DECAY};
+        std::vector<float> sensorDistances{SimulationDefaults::SPORE_SENSOR_DISTANCE};
+        std::vector<float> sensorAngles{SimulationDefaults::SPORE_SENSOR_ANGLE};
+        int gridSize = 64;
+        int sporeCount = 20'000;   // Per run
+        int steps = 600;
+        float deltaTime = 1.0f / 60.0f;
+        int seed = SimulationDefaults::SEED;
+        int batchSize = 16;        // Runs simulated side by side
+        bool wrap = true;
+        bool trilinearSensing = false;
+        std::string thumbnailPrefix; // Writes <prefix>_<batch>.ppm, a projection of every run in the batch, when set
+        std::string jsonPath = "sweep.json";
+        std::string csvPath = "sweep.csv";
+    };
+
+    struct RunResult {
+        int run = 0;
+        int batch = 0;
+        SimulationData settings{};
+        double trailMass = 0.0;        // Sum of the trail over the grid
+        float meanTrail = 0.0f;
+        float maxTrail = 0.0f;
+        float occupancyFraction = 0.0f; // Voxels holding any trail
+        float batchMilliseconds = 0.0f; // GPU time of all steps of the batch
+        float runMilliseconds = 0.0f;   // Its share per run
+    };
+
+    std::vector<std::string> splitList(const std::string& list) {
+        std::vector<std::string> items;
+        std::stringstream stream(list);
+        std::string item;
+        while (std::getline(stream, item, ',')) {
+            if (!item.empty()) {
+                items.push_back(item);
+            }
+        }
+        return items;
+    }
+
+    std::vector<float> parseFloatList(const std::string& list) {
+        std::vector<float> values;
+        for (const std::string& item : splitList(list)) {
+            values.push_back(std::stof(item));
+        }
+        if (values.empty()) {
+            throw std::runtime_error("Empty value list " + list);
+        }
+        return values;
+    }
+
+    SweepOptions parseOptions(const int argc, char** argv) {
+        SweepOptions options;
+
+        for (int i = 1; i < argc; ++i) {
+            const std::string argument = argv[i];
+            if (i + 1 >= argc) {
+                throw std::invalid_argument("Missing value for " + argument);
+            }
+            const std::string value = argv[++i];
+
+            if (argument == "--spore-speed") {
+                options.sporeSpeeds = parseFloatList(value);
+            } else if (argument == "--turn-speed") {
+                options.turnSpeeds = parseFloatList(value);
+            } else if (argument == "--decay-speed") {
+                options.decaySpeeds = parseFloatList(value);
+            } else if (argument == "--sensor-distance") {
+                options.sensorDistances = parseFloatList(value);
+            } else if (argument == "--sensor-angle") {
+                options.sensorAngles = parseFloatList(value);
+            } else if (argument == "--grid") {
+                options.gridSize = std::stoi(value);
+                const int maxGridSize = static_cast<int>(SimulationDefaults::MAX_GRID_SIZE);
+                if (options.gridSize < 8 || options.gridSize > maxGridSize) {
+                    throw std::invalid_argument("--grid must be between 8 and " + std::to_string(maxGridSize));
+                }
+            } else if (argument == "--spores") {
+                options.sporeCount = std::max(1, std::stoi(value));
+            } else if (argument == "--steps") {
+                options.steps = std::max(1, std::stoi(value));
+            } else if (argument == "--delta-time") {
+                options.deltaTime = std::stof(value);
+            } else if (argument == "--seed") {
+                options.seed = std::stoi(value);
+            } else if (argument == "--batch") {
+                options.batchSize = std::stoi(value);
+                if (options.batchSize <= 0) {
+                    throw std::invalid_argument("--batch must be at least 1");
+                }
+            } else if (argument == "--wrap") {
+                options.wrap = std::stoi(value) != 0;
+            } else if (argument == "--trilinear") {
+                options.trilinearSensing = std::stoi(value) != 0;
+            } else if (argument == "--thumbnails") {
+                options.thumbnailPrefix = value;
+            } else if (argument == "--json") {
+                options.jsonPath = value;
+            } else if (argument == "--csv") {
+                options.csvPath = value;
+            } else {
+                throw std::invalid_argument("Unknown argument " + argument);
+            }
+        }
+
+        return options;
+    }
+
+    // Every combination of the swept values, the sensor angle changing fastest
+    std::vector<SimulationData> sweepCombinations(const SweepOptions& options) {
+        std::vector<SimulationData> combinations;
+
+        SimulationData settings{};
+        settings.grid_size = options.gridSize;
+        settings.spore_count = options.sporeCount;
+        settings.sdf_reduction = SimulationDefaults::SDF_REDUCTION_FACTOR;
+        settings.grid_resize_factor = 1.0f;
+        settings.diffusion_rate = SimulationDefaults::TRAIL_DIFFUSION_RATE;
+        settings.seed = options.seed;
+
+        for (const float sporeSpeed : options.sporeSpeeds) {
+            for (const float turnSpeed : options.turnSpeeds) {
+                for (const float decaySpeed : options.decaySpeeds) {
+                    for (const float sensorDistance : options.sensorDistances) {
+                        for (const float sensorAngle : options.sensorAngles) {
+                            settings.spore_speed = sporeSpeed;
+                            settings.turn_speed = turnSpeed;
+                            settings.decay_speed = decaySpeed;
+                            settings.sensor_distance = sensorDistance;
+                            settings.sensor_angle = sensorAngle;
+                            combinations.push_back(settings);
+                        }
+                    }
+                }
+            }
+        }
+
+        return combinations;
+    }
+}
+
+
+class ParameterSweep : public GameEngine {
+public:
+    explicit ParameterSweep(SweepOptions options)
+        : GameEngine(64, 64, "MoldLab3D Parameter Sweep", false, true), options(std::move(options)) {
+        addShaderDefinition("#define SIMULATION_SETTINGS", "include/SimulationData.h");
+        addShaderDefinition("#define SPORE_STRUCT", "include/Spore.h");
+        addShaderDefinition("#define OCCUPANCY_DATA", "include/OccupancyData.h");
+        addShaderDefinition("#define TRAIL_ACCESS", "shaders/trail_access.glsl");
+        addShaderDefinition("#define ENSEMBLE_MEMBERS", "shaders/ensemble.glsl");
+        addShaderDefinition("#define RANDOM_NUMBERS", "include/Random.h");
+        setShaderVariant("#define USE_ENSEMBLE", true);
+        setShaderVariant("#define WRAP_AROUND", this->options.wrap);
+        setShaderVariant("#define USE_TRILINEAR_SENSING", this->options.trilinearSensing);
+        setShaderVariant("#define USE_TRAIL_SAMPLER", false);
+        setShaderVariant("#define USE_LOD_SENSING", false);
+        setShaderVariant("#define USE_DIFFUSION", false);
+        setShaderVariant("#define USE_SPORE_LIFECYCLE", false);
+    }
+
+    void runAll() {
+        renderingStart();
+
+        const std::vector<SimulationData> combinations = sweepCombinations(options);
+
+        // The largest batch shares one 3D texture, its tiles have to fit the driver's limit
+        GLint max3DTextureSize = 0;
+        glGetIntegerv(GL_MAX_3D_TEXTURE_SIZE, &max3DTextureSize);
+        const int largestBatch = static_cast<int>(std::min<size_t>(combinations.size(), options.batchSize));
+        const int atlasSize = Ensemble::atlasSizeFor(options.gridSize, largestBatch);
+        if (atlasSize > max3DTextureSize) {
+            throw std::invalid_argument("--grid " + std::to_string(options.gridSize) + " and --batch " + std::to_string(largestBatch) +
+                                        " need a " + std::to_string(atlasSize) + " wide atlas, GL_MAX_3D_TEXTURE_SIZE is " + std::to_string(max3DTextureSize));
+        }
+        const int batchCount = (static_cast<int>(combinations.size()) + options.batchSize - 1) / options.batchSize;
+        std::cout << combinations.size() << " runs in " << batchCount << " batches of up to " << options.batchSize << std::endl;
+
+        const auto sweepStart = std::chrono::steady_clock::now();
+        for (int batch = 0; batch < batchCount; ++batch) {
+            const auto first = combinations.begin() + batch * options.batchSize;
+            const auto last = combinations.begin() + std::min<size_t>(combinations.size(), static_cast<size_t>(batch + 1) * options.batchSize);
+            runBatch(batch, std::vector<SimulationData>(first, last));
+        }
+        const float sweepSeconds = std::chrono::duration<float>(std::chrono::steady_clock::now() - sweepStart).count();
+        std::cout << "Sweep finished in " << sweepSeconds << " s" << std::endl;
+
+        writeJson();
+        writeCsv();
+    }
+
+protected:
+    void renderingStart() override {
+        EnsemblePrograms programs;
+        programs.randomizeSpores = CreateShaderProgram({{"shaders/randomize_spores.glsl", GL_COMPUTE_SHADER, false}});
+        programs.moveSpores = CreateShaderProgram({{"shaders/move_spores.glsl", GL_COMPUTE_SHADER, false}});
+        programs.drawSpores = CreateShaderProgram({{"shaders/draw_spores.glsl", GL_COMPUTE_SHADER, false}});
+        programs.decaySpores = CreateShaderProgram({{"shaders/decay_spores.glsl", GL_COMPUTE_SHADER, false}});
+        programs.clearGrid = CreateShaderProgram({{"shaders/clear_grid.glsl", GL_COMPUTE_SHADER, false}});
+        ensemble.setPrograms(programs);
+
+        projection.setProgram(CreateShaderProgram({{"shaders/project_trail.glsl", GL_COMPUTE_SHADER, false}}));
+    }
+
+    void start() override {}
+    void update(float) override {}
+    void render() override {}
+    void renderUI() override {}
+
+private:
+    void runBatch(const int batch, const std::vector<SimulationData>& runs) {
+        ensemble.configure(runs);
+        if (batch == 0) {
+            checkInitialSpores();
+        }
+
+        timer.begin();
+        for (int step = 0; step < options.steps; ++step) {
+            ensemble.step(options.deltaTime);
+        }
+        timer.end();
+        const float batchMilliseconds = timer.waitMilliseconds();
+
+        ensemble.readAtlas(atlasValues);
+        CheckGLError("Parameter sweep batch");
+
+        const int gridSize = ensemble.gridSize();
+        const size_t atlasWidth = ensemble.atlasSize();
+        const size_t atlasHeight = static_cast<size_t>(ensemble.tileRowCount()) * gridSize;
+        const double voxelCount = static_cast<double>(gridSize) * gridSize * gridSize;
+
+        for (int member = 0; member < ensemble.memberCount(); ++member) {
+            RunResult result;
+            result.run = static_cast<int>(results.size());
+            result.batch = batch;
+            result.settings = ensemble.member(member);
+            result.batchMilliseconds = batchMilliseconds;
+            result.runMilliseconds = batchMilliseconds / static_cast<float>(ensemble.memberCount());
+
+            const size_t originX = static_cast<size_t>(member % ensemble.tilesPerRow()) * gridSize;
+            const size_t originY = static_cast<size_t>(member / ensemble.tilesPerRow()) * gridSize;
+            size_t occupiedVoxels = 0;
+            for (int z = 0; z < gridSize; ++z) {
+                for (int y = 0; y < gridSize; ++y) {
+                    const float* row = &atlasValues[originX + atlasWidth * (originY + y + atlasHeight * z)];
+                    for (int x = 0; x < gridSize; ++x) {
+                        result.trailMass += row[x];
+                        result.maxTrail = std::max(result.maxTrail, row[x]);
+                        occupiedVoxels += row[x] > 0.0f;
+                    }
+                }
+            }
+            result.meanTrail = static_cast<float>(result.trailMass / voxelCount);
+            result.occupancyFraction = static_cast<float>(static_cast<double>(occupiedVoxels) / voxelCount);
+
+            results.push_back(result);
+            printResult(result);
+        }
+
+        if (!options.thumbnailPrefix.empty()) {
+            ensemble.bind();
+            projection.project(ensemble.atlasSize(), ProjectionSettings{}, ensemble.generation());
+            projection.saveThumbnail(options.thumbnailPrefix + "_" + std::to_string(batch) + ".ppm", ensemble.atlasSize(), 1.0f);
+        }
+    }
+
+    // Runs are only comparable across machines when they start from the same spores, the positions are bit-identical
+    // to the ones the shared generator gives on the CPU
+    void checkInitialSpores() {
+        std::vector<Spore> spores;
+        ensemble.readSpores(0, spores);
+
+        const auto seed = static_cast<Random::uint>(options.seed);
+        const auto gridSize = static_cast<float>(ensemble.gridSize());
+        size_t mismatches = 0;
+        for (size_t spore = 0; spore < spores.size(); ++spore) {
+            for (int axis = 0; axis < 3; ++axis) {
+                const float expected = Random::random_unit(seed, static_cast<Random::uint>(spore), SPORE_DRAW_POSITION + axis) * gridSize;
+                mismatches += spores[spore].position[axis] != expected;
+            }
+        }
+
+        if (mismatches == 0) {
+            std::cout << "Initial spores of seed " << options.seed << " match the CPU" << std::endl;
+        } else {
+            std::cerr << mismatches << " initial spore coordinates of seed " << options.seed << " differ from the CPU" << std::endl;
+        }
+    }
+
+    static void printResult(const RunResult& result) {
+        std::cout << "run " << result.run << " (batch " << result.batch << ") speed " << result.settings.spore_speed
+                  << " turn " << result.settings.turn_speed << " decay " << result.settings.decay_speed
+                  << " distance " << result.settings.sensor_distance << " angle " << result.settings.sensor_angle
+                  << ": mass " << result.trailMass << ", occupancy " << result.occupancyFraction
+                  << ", " << result.runMilliseconds << " ms GPU" << std::endl;
+    }
+
+    void writeJson() const {
+        std::ofstream file(options.jsonPath);
+        if (!file) {
+            std::cerr << "Failed to write " << options.jsonPath << std::endl;
+            return;
+        }
+
+        file << "[\n";
+        for (size_t i = 0; i < results.size(); ++i) {
+            const RunResult& result = results[i];
+            file << "  {\"run\": " << result.run
+                 << ", \"batch\": " << result.batch
+                 << ", \"grid_size\": " << result.settings.grid_size
+                 << ", \"spore_count\": " << result.settings.spore_count
+                 << ", \"steps\": " << options.steps
+                 << ", \"seed\": " << result.settings.seed
+                 << ", \"spore_speed\": " << result.settings.spore_speed
+                 << ", \"turn_speed\": " << result.settings.turn_speed
+                 << ", \"decay_speed\": " << result.settings.decay_speed
+                 << ", \"sensor_distance\": " << result.settings.sensor_distance
+                 << ", \"sensor_angle\": " << result.settings.sensor_angle
+                 << ", \"trail_mass\": " << result.trailMass
+                 << ", \"mean_trail\": " << result.meanTrail
+                 << ", \"max_trail\": " << result.maxTrail
+                 << ", \"occupancy_fraction\": " << result.occupancyFraction
+                 << ", \"batch_ms\": " << result.batchMilliseconds
+                 << ", \"run_ms\": " << result.runMilliseconds
+                 << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+        file << "]\n";
+    }
+
+    void writeCsv() const {
+        std::ofstream file(options.csvPath);
+        if (!file) {
+            std::cerr << "Failed to write " << options.csvPath << std::endl;
+            return;
+        }
+
+        file << "run,batch,grid_size,spore_count,steps,seed,spore_speed,turn_speed,decay_speed,sensor_distance,sensor_angle,"
+                "trail_mass,mean_trail,max_trail,occupancy_fraction,batch_ms,run_ms\n";
+        for (const RunResult& result : results) {
+            file << result.run << ',' << result.batch << ',' << result.settings.grid_size << ',' << result.settings.spore_count << ','
+                 << options.steps << ',' << result.settings.seed << ',' << result.settings.spore_speed << ',' << result.settings.turn_speed << ','
+                 << result.settings.decay_speed << ',' << result.settings.sensor_distance << ',' << result.settings.sensor_angle << ','
+                 << result.trailMass << ',' << result.meanTrail << ',' << result.maxTrail << ',' << result.occupancyFraction << ','
+                 << result.batchMilliseconds << ',' << result.runMilliseconds << '\n';
+        }
+    }
+
+    SweepOptions options;
+    std::vector<RunResult> results;
+
+    Ensemble ensemble;
+    TrailProjection projection;
+    GpuTimer timer;
+    std::vector<float> atlasValues;
+};
+
+
+int main(const int argc, char** argv) {
+    try {
+        ParameterSweep sweep(parseOptions(argc, argv));
+        sweep.runAll();
+    } catch (const std::invalid_argument& exception) {
+        std::cerr << exception.what() << std::endl << USAGE << std::endl;
+        return 1;
+    } catch (const std::exception& exception) {
+        std::cerr << exception.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}